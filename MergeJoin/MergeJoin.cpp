@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include "MergeJoin/pmergejoin.h"
+#define MEASURE_JUMP_NO_MAIN
 #include "skipjoin/source/measure_jump.cpp"
 
 
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <functional>
+#include <numeric>
 #include <optional>
+#include <unordered_map>
 
 #include "skipjoin/source/stab_forest.hpp"
+#include "skipjoin/source/stab_forest_file.hpp"
 #include "skipjoin/source/temporal_join.hpp"
 #include "parallelskipjoinhelper.h"
 
@@ -57,27 +61,104 @@ void partial_forward_skip_join(auto const& lhs, auto const& rhs, auto lit, auto
 	}
 }
 
-
-void spill_over_join(auto lit, auto lend, auto rit, auto rend, auto output)
-{// check if rhs is sorted on start time.
+/**
+ * Sweep-based band join with skipping (see forward_band_skip_join).
+ */
+void partial_forward_band_skip_join(auto const& lhs, auto const& rhs, auto const delta, auto lit, auto lend, auto rit, auto rend, auto output, auto const& policy_l, auto const& policy_r)
+{
 	if (lit == lend || rit == rend) {
 		return;
 	}
 
 	using namespace temporal_join_details;
 
-	auto stab_rj = make_stab_result_join<join_1>(rend, output);
-	stab_rj.set_iterator(rit);
+	auto stab_left_rj = make_stab_result_join<join_1>(rend, output, delta);
+	auto stab_right_rj = make_stab_result_join<join_2>(lend, output, delta);
 
-	while (lit != lend)
+	auto lhelper = lhs.stab_forward_search_shared(std::back_inserter(stab_left_rj), policy_l);
+	auto rhelper = rhs.stab_forward_search_shared(std::back_inserter(stab_right_rj), policy_r);
+
+	while (lit != lend && rit != rend)
 	{
-		stab_rj.push_back(*lit);
-		++lit;
+		if (lit->start <= rit->start)
+		{
+			stab_left_rj.set_iterator(rit);
+			if (rit->start <= saturating_add(lit->end, delta))
+			{
+				stab_left_rj.push_back(*lit);
+				++lit;
+			}
+			else
+			{
+				lhelper->stab_forward(rit->start - delta, &lit);
+			}
+		}
+		else
+		{
+			stab_right_rj.set_iterator(lit);
+			if (lit->start <= saturating_add(rit->end, delta))
+			{
+				stab_right_rj.push_back(*rit);
+				++rit;
+			}
+			else
+			{
+				rhelper->stab_forward(lit->start - delta, &rit);
+			}
+		}
 	}
 }
 
 
-static JoinTaskHandler* join_task_consumer = nullptr;
+/**
+ * Output iterator that pushes the events starting at-or-after first into a
+ * stab_result_join. Stab results of earlier partitions are dropped.
+ */
+template <typename StabResultJoin, typename ValueType>
+class SpillOverInserter
+{
+public:
+	SpillOverInserter(ValueType first, StabResultJoin& stab_rj) : _first(first), _stab_rj(&stab_rj) {}
+
+	SpillOverInserter& operator*() { return *this; }
+	SpillOverInserter& operator++() { return *this; }
+	SpillOverInserter& operator++(int) { return *this; }
+
+	SpillOverInserter& operator=(auto const& event)
+	{
+		if (event.start >= _first) {
+			_stab_rj->push_back(event);
+		}
+		return *this;
+	}
+
+private:
+	ValueType _first;
+	StabResultJoin* _stab_rj;
+};
+
+
+/**
+ * Join the events of forest that start at-or-after first and are active at
+ * value with the events in [rit, rend) that start at-or-before their end. The
+ * events in [rit, rend) must start after value. The spill-over events are
+ * produced by the stab itself, hence they are never copied into a buffer. Use
+ * join_2 when forest is the right-hand side.
+ */
+template <typename Join = temporal_join_details::join_1>
+void spill_over_join(auto const& forest, auto const value, auto const first, auto rit, auto rend, auto output)
+{
+	if (rit == rend) {
+		return;
+	}
+
+	using namespace temporal_join_details;
+
+	auto stab_rj = make_stab_result_join<Join>(rend, output);
+	stab_rj.set_iterator(rit);
+
+	forest.stab_search(value, SpillOverInserter(first, stab_rj));
+}
 
 
 template<typename ValueType>
@@ -155,7 +236,9 @@ auto find_median(auto lit, auto lend, auto rit, auto rend, bool exit = false)
 		} else if (index_compare(rit, lit, e_m, { mid }, m2_size, m1_size)) {
 			end = mid;
 		}
-		else if (index_compare(rit, lit, e_m_1, { mid }, m2_size, m1_size) && index_compare(lit, rit, { mid }, e_m, m1_size, m2_size)) {
+		else if (mid < m1_size) {
+			// m2[e_val - mid - 1] <= m1[mid] <= m2[e_val - mid]; the comparisons
+			// above are strict, so equal start-times on both sides end up here.
 			return std::next(lit, mid)->start;
 		} else {
 			throw std::runtime_error("FindMedian falls into wrong else statement!");
@@ -168,74 +251,355 @@ auto find_median(auto lit, auto lend, auto rit, auto rend, bool exit = false)
 }
 
 
+/**
+ * Partitioner that splits on the median start-time of both ranges, giving both
+ * halves the same number of input events.
+ */
+struct MedianPartitioner
+{
+	auto operator()(auto const& /*lhs*/, auto const& /*rhs*/, auto lit, auto lend, auto rit, auto rend) const
+	{
+		return find_median(lit, lend, rit, rend);
+	}
+};
+
+
+/**
+ * Partitioner that splits where the estimated join work is halved. The work is
+ * estimated at a sample of candidate start-times: every event starting between
+ * two candidates costs one step plus one join result per event of the other
+ * side that is active at the candidates, counted by stabbing both forests.
+ */
+struct OutputBalancedPartitioner
+{
+	OutputBalancedPartitioner(std::size_t samples = 16) : samples(std::max<std::size_t>(2u, samples)) {}
+
+	auto operator()(auto const& lhs, auto const& rhs, auto lit, auto lend, auto rit, auto rend) const
+	{
+		using EventType = std::iterator_traits<decltype(lit)>::value_type;
+		using ValueType = EventType::unsigned_type;
+
+		std::size_t l_size = std::distance(lit, lend);
+		std::size_t r_size = std::distance(rit, rend);
+
+		// candidate split points: evenly spaced start-times of both ranges
+		std::vector<ValueType> candidates;
+		candidates.reserve(samples);
+		for (std::size_t i = 1; i <= samples / 2; ++i) {
+			candidates.push_back(std::next(lit, (l_size * i) / (samples / 2 + 1))->start);
+			candidates.push_back(std::next(rit, (r_size * i) / (samples / 2 + 1))->start);
+		}
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+		// estimated work of the events that start at-or-before each candidate
+		auto l_first = lit->start;
+		auto r_first = rit->start;
+		std::vector<double> work(candidates.size());
+		std::size_t l_prev = 0, r_prev = 0;
+		double total = 0.0;
+		for (std::size_t i = 0; i < candidates.size(); ++i) {
+			auto c = candidates[i];
+			auto l_upto = (std::size_t)std::distance(lit, std::upper_bound(lit, lend, c, EventType::start_compare()));
+			auto r_upto = (std::size_t)std::distance(rit, std::upper_bound(rit, rend, c, EventType::start_compare()));
+
+			std::size_t l_active = 0, r_active = 0;
+			lhs.stab_search(c, StabCounter(l_first, l_active));
+			rhs.stab_search(c, StabCounter(r_first, r_active));
+
+			total += (l_upto - l_prev) * (1.0 + r_active) + (r_upto - r_prev) * (1.0 + l_active);
+			work[i] = total;
+			l_prev = l_upto;
+			r_prev = r_upto;
+		}
+
+		// the events after the last candidate only cost their own steps
+		total += (l_size - l_prev) + (r_size - r_prev);
+
+		auto half = std::lower_bound(work.begin(), work.end(), total / 2);
+		if (half == work.end()) {
+			return candidates.back();
+		}
+		return candidates[std::distance(work.begin(), half)];
+	}
+
+	std::size_t samples;
+
+private:
+	/**
+	 * Output iterator that counts the stab results starting at-or-after the
+	 * first start-time of the partition.
+	 */
+	template <typename ValueType>
+	class StabCounter
+	{
+	public:
+		StabCounter(ValueType first, std::size_t& count) : _first(first), _count(&count) {}
+
+		StabCounter& operator*() { return *this; }
+		StabCounter& operator++() { return *this; }
+		StabCounter& operator++(int) { return *this; }
+
+		StabCounter& operator=(auto const& event)
+		{
+			if (event.start >= _first) {
+				++*_count;
+			}
+			return *this;
+		}
+
+	private:
+		ValueType _first;
+		std::size_t* _count;
+	};
+};
+
+
+/**
+ * Join [lit, lend) with [rit, rend) by splitting both ranges f - 1 times on the
+ * median start-time. Meant to run as a task of pool: every split appends the
+ * joins of the spill-over events and both halves as new tasks to pool, hence
+ * the median searches and the stab splits of a subtree run on the worker that
+ * picks it up.
+ */
 template <typename EventType>
-void recursive_join(std::size_t const f, auto const& lhs, auto const& rhs, auto lit, auto lend, auto rit, auto rend, auto& outputs, auto const& policy_l, auto const& policy_r)
+void recursive_join(JoinTaskHandler& pool, std::size_t const f, int const worker, auto const& lhs, auto const& rhs, auto lit, auto lend, auto rit, auto rend, auto& outputs, auto const& policy_l, auto const& policy_r, auto const& partitioner)
 {
 	if (lit == lend || rit == rend) {
 		return;
 	}
 
 	if (f == 1) {
-		auto output_it = outputs.get_iterator();
-		join_task_consumer->append_task([&lhs, &rhs, lit, lend, rit, rend, output_it, &policy_l, &policy_r](int /*i*/) {
-			partial_forward_skip_join(lhs, rhs, lit, lend, rit, rend, output_it, policy_l, policy_r);
-		});
+		partial_forward_skip_join(lhs, rhs, lit, lend, rit, rend, outputs.get_iterator(worker), policy_l, policy_r);
 	} else { 
 		using namespace temporal_join_details;
 
-		auto m_val = find_median(lit, lend, rit, rend);
-
-		auto output_it = outputs.get_iterator();
-		auto stab_left_rj = make_stab_result_join<join_1>(rend, output_it);
-		auto stab_right_rj = make_stab_result_join<join_2>(lend, output_it);
-
-		auto lhelper = lhs.stab_forward_search_shared(std::back_inserter(stab_left_rj), policy_l);
-		auto rhelper = rhs.stab_forward_search_shared(std::back_inserter(stab_right_rj), policy_r);
+		auto m_val = partitioner(lhs, rhs, lit, lend, rit, rend);
 
 		// llow = [lit, lmid_it); lhigh = [lmid_it, lend)
-		std::vector<EventType> l_range_after;  // holds all events in llow that need to join with rhigh
-		auto lmid_it = lhelper->stab_search(m_val, std::back_inserter(l_range_after));
-
 		// rlow = [rit, rmid_it); rhigh = [rmid_it, rend)
-		std::vector<EventType> r_range_after;  // holds all events in rlow that need to join with lhigh
-		auto rmid_it = rhelper->stab_search(m_val, std::back_inserter(r_range_after));
+		auto lmid_it = std::upper_bound(lit, lend, m_val, EventType::start_compare());
+		auto rmid_it = std::upper_bound(rit, rend, m_val, EventType::start_compare());
 
-		// join all events in llow that need to join with rhigh
-		output_it = outputs.get_iterator();
-		join_task_consumer->append_task([l_range_after, rmid_it, rend, output_it](int /*i*/) {
-			spill_over_join(l_range_after.cbegin(), l_range_after.cend(), rmid_it, rend, output_it);
+		// join all events in llow that are active at m_val with rhigh
+		auto l_first = lit->start;
+		pool.append_task([&lhs, m_val, l_first, rmid_it, rend, &outputs](int i) {
+			spill_over_join(lhs, m_val, l_first, rmid_it, rend, outputs.get_iterator(i));
 		});
-		// join all events in rlow that need to join with lhigh
-		output_it = outputs.get_iterator();
-		join_task_consumer->append_task([r_range_after, lmid_it, lend, output_it](int /*i*/) {
-			spill_over_join(lmid_it, lend, r_range_after.cbegin(), r_range_after.cend(), output_it);
+		// join all events in rlow that are active at m_val with lhigh
+		auto r_first = rit->start;
+		pool.append_task([&rhs, m_val, r_first, lmid_it, lend, &outputs](int i) {
+			spill_over_join<join_2>(rhs, m_val, r_first, lmid_it, lend, outputs.get_iterator(i));
 		});
 
 		//join llow & rlow, lhigh & rhigh
-		recursive_join<EventType>(f - 1, lhs, rhs, lit, lmid_it, rit, rmid_it, outputs, policy_l, policy_r);
-		recursive_join<EventType>(f - 1, lhs, rhs, lmid_it, lend, rmid_it, rend, outputs, policy_l, policy_r);
+		pool.append_task([&pool, f, &lhs, &rhs, lit, lmid_it, rit, rmid_it, &outputs, &policy_l, &policy_r, &partitioner](int i) {
+			recursive_join<EventType>(pool, f - 1, i, lhs, rhs, lit, lmid_it, rit, rmid_it, outputs, policy_l, policy_r, partitioner);
+		});
+		pool.append_task([&pool, f, &lhs, &rhs, lmid_it, lend, rmid_it, rend, &outputs, &policy_l, &policy_r, &partitioner](int i) {
+			recursive_join<EventType>(pool, f - 1, i, lhs, rhs, lmid_it, lend, rmid_it, rend, outputs, policy_l, policy_r, partitioner);
+		});
 	}
 };
 
 
-template <typename Forest, typename Outputs, typename JumpPolicyL, typename JumpPolicyR>
+/**
+ * Join lhs and rhs on the workers of pool, splitting the work into 2^(f - 1)
+ * partitions. The partitioner picks the split point of every partition, see
+ * MedianPartitioner and OutputBalancedPartitioner. Tasks write their results to
+ * outputs.get_iterator(worker), with worker in [0, pool.size()). The pool keeps
+ * running afterwards, e.g., to merge the outputs.
+ */
+template <typename Forest, typename Outputs, typename JumpPolicyL, typename JumpPolicyR, typename Partitioner = MedianPartitioner>
+void parallel_join(WorkStealingPoolHandler& pool, std::size_t const f, Forest const& lhs, Forest const& rhs,
+	Outputs& outputs, const JumpPolicyL& policy_l, const JumpPolicyR& policy_r, const Partitioner& partitioner = Partitioner())
+{
+	using namespace temporal_join_details;
+	using EventType = typename Forest::event;
+
+	pool.append_task([&pool, f, &lhs, &rhs, &outputs, &policy_l, &policy_r, &partitioner](int i) {
+		recursive_join<EventType>(pool, f, i, lhs, rhs, lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend(), outputs, policy_l, policy_r, partitioner);
+	});
+
+	pool.wait();
+};
+
+/**
+ * Join lhs and rhs on n_threads workers, see above.
+ */
+template <typename Forest, typename Outputs, typename JumpPolicyL, typename JumpPolicyR, typename Partitioner = MedianPartitioner>
 void parallel_join(std::size_t n_threads, std::size_t const f, Forest const& lhs, Forest const& rhs,
-	Outputs& outputs, const JumpPolicyL& policy_l, const JumpPolicyR& policy_r)
+	Outputs& outputs, const JumpPolicyL& policy_l, const JumpPolicyR& policy_r, const Partitioner& partitioner = Partitioner())
 {
-	if (join_task_consumer) {
-		join_task_consumer->join();
-		delete join_task_consumer;
+	WorkStealingPoolHandler pool(n_threads);
+	parallel_join(pool, f, lhs, rhs, outputs, policy_l, policy_r, partitioner);
+};
+
+/**
+ * Per-key stab-forests of a keyed join. The (key, event)-pairs are partitioned
+ * on key with a hash table, after which the stab-forest of every key is built
+ * on the thread pool and written as a stab-forest image into one shared arena.
+ * The stab-forests are kept until the arena is sized to fit all images, after
+ * which every image is written in-place in its slot of the arena and its
+ * stab-forest is released. The per-key stab-forests are used in-place in the
+ * arena (see mapped_stab_forest), hence the events and the indices of all keys
+ * are held in a single allocation instead of in a handful of allocations per
+ * key.
+ */
+template <typename Key, typename TimeStampType, typename Hash = std::hash<Key>>
+class KeyedForests
+{
+public:
+	using EventType = interval<TimeStampType>;
+	using Forest = mapped_stab_forest<TimeStampType>;
+
+	/**
+	 * Build the per-key stab-forests of the (key, event)-pairs in [first, last),
+	 * which can be in any order, on n_threads threads.
+	 */
+	template <typename ForwardIt>
+	KeyedForests(ForwardIt first, ForwardIt last, std::size_t n_threads = 1)
+	{
+		// partition the events on key, keeping the events of a key contiguous
+		std::vector<std::size_t> slots;
+		std::vector<std::size_t> offsets(1, 0);
+		for (auto it = first; it != last; ++it) {
+			auto [slot, inserted] = _slots.try_emplace(it->first, _keys.size());
+			if (inserted) {
+				_keys.push_back(it->first);
+				offsets.push_back(0);
+			}
+			slots.push_back(slot->second);
+			++offsets[slot->second + 1];
+		}
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+		std::vector<EventType> events(offsets.back());
+		std::vector<std::size_t> positions(offsets.begin(), offsets.end() - 1);
+		auto slot = slots.cbegin();
+		for (auto it = first; it != last; ++it, ++slot) {
+			events[positions[*slot]++] = it->second;
+		}
+
+		// build the stab-forest of every key and size its image
+		std::vector<stab_forest<TimeStampType>> forests(_keys.size());
+		std::vector<std::size_t> image_sizes(_keys.size());
+		WorkStealingPoolHandler pool(n_threads);
+		for (std::size_t k = 0; k < _keys.size(); ++k) {
+			pool.append_task([&events, &offsets, &forests, &image_sizes, k](int) {
+				auto begin = events.begin() + offsets[k];
+				auto end = events.begin() + offsets[k + 1];
+				std::sort(begin, end, EventType::start_end_compare());
+				forests[k] = stab_forest<TimeStampType>(begin, end);
+				image_sizes[k] = Forest::image_size(forests[k]);
+			});
+		}
+		pool.wait();
+		events = std::vector<EventType>();
+
+		// serialize every stab-forest in-place into the arena, every image at a
+		// 64-byte boundary
+		std::vector<std::size_t> image_offsets;
+		std::size_t size = 0;
+		for (auto image_size : image_sizes) {
+			image_offsets.push_back(size);
+			size += (image_size + sizeof(ArenaLine) - 1) / sizeof(ArenaLine);
+		}
+		_arena.resize(size);
+		for (std::size_t k = 0; k < _keys.size(); ++k) {
+			pool.append_task([this, &forests, &image_offsets, k](int) {
+				Forest::write(reinterpret_cast<char*>(_arena.data() + image_offsets[k]), forests[k]);
+				forests[k] = stab_forest<TimeStampType>();
+			});
+		}
+		pool.join();
+
+		_forests.reserve(_keys.size());
+		for (std::size_t k = 0; k < _keys.size(); ++k) {
+			_forests.emplace_back(reinterpret_cast<const char*>(_arena.data() + image_offsets[k]), image_sizes[k]);
+		}
 	}
 
-	// join_task_consumer = new ThreadPoolHandler(n_threads);
-	join_task_consumer = new ThreadsHandler();
+	KeyedForests(KeyedForests&&) = default;
+	KeyedForests(KeyedForests const&) = delete;
 
-	using namespace temporal_join_details;
-	using EventType = typename Forest::event;
+	/**
+	 * Return the number of keys.
+	 */
+	std::size_t size() const
+	{
+		return _keys.size();
+	}
 
-	recursive_join<EventType>(f, lhs, rhs, lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend(), outputs, policy_l, policy_r);
-	
-	join_task_consumer->join();
-	delete join_task_consumer;
-	join_task_consumer = nullptr;
-};
\ No newline at end of file
+	/**
+	 * Return the key and the stab-forest with the provided number.
+	 */
+	const Key& key(std::size_t i) const
+	{
+		return _keys[i];
+	}
+	const Forest& forest(std::size_t i) const
+	{
+		return _forests[i];
+	}
+
+	/**
+	 * Return the stab-forest of the provided key, or a null pointer if there
+	 * are no events with that key.
+	 */
+	const Forest* find(const Key& key) const
+	{
+		auto it = _slots.find(key);
+		return (it == _slots.end()) ? nullptr : &_forests[it->second];
+	}
+
+private:
+	struct alignas(64) ArenaLine
+	{
+		char bytes[64];
+	};
+
+	std::unordered_map<Key, std::size_t, Hash> _slots;
+	std::vector<Key> _keys;
+	std::vector<ArenaLine> _arena;
+	std::vector<Forest> _forests;
+};
+
+
+/**
+ * Join the events of lhs and rhs with equal keys on n_threads workers: the
+ * stab-forests of every key present in both are joined by forward_skip_join in
+ * a task of their own, largest keys first. Tasks write their results to
+ * outputs.get_iterator(worker, key) if Outputs provides it, and to
+ * outputs.get_iterator(worker) otherwise.
+ */
+template <typename Key, typename TimeStampType, typename Hash, typename Outputs, typename JumpPolicyL, typename JumpPolicyR>
+void keyed_parallel_join(std::size_t n_threads, KeyedForests<Key, TimeStampType, Hash> const& lhs, KeyedForests<Key, TimeStampType, Hash> const& rhs,
+	Outputs& outputs, const JumpPolicyL& policy_l, const JumpPolicyR& policy_r)
+{
+	using Forest = typename KeyedForests<Key, TimeStampType, Hash>::Forest;
+
+	std::vector<std::pair<Forest const*, std::size_t>> pairs;
+	for (std::size_t i = 0; i < lhs.size(); ++i) {
+		if (auto other = rhs.find(lhs.key(i))) {
+			pairs.emplace_back(other, i);
+		}
+	}
+	std::sort(pairs.begin(), pairs.end(), [&lhs](auto const& a, auto const& b) {
+		return lhs.forest(a.second).size() + a.first->size() > lhs.forest(b.second).size() + b.first->size();
+	});
+
+	WorkStealingPoolHandler pool(n_threads);
+	for (auto const& [other, i] : pairs) {
+		pool.append_task([&lhs, &outputs, &policy_l, &policy_r, other = other, i = i](int worker) {
+			auto const& key = lhs.key(i);
+			if constexpr (requires { outputs.get_iterator(worker, key); }) {
+				forward_skip_join(lhs.forest(i), *other, outputs.get_iterator(worker, key), policy_l, policy_r);
+			}
+			else {
+				forward_skip_join(lhs.forest(i), *other, outputs.get_iterator(worker), policy_l, policy_r);
+			}
+		});
+	}
+	pool.join();
+};
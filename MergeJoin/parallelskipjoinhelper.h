@@ -1,8 +1,23 @@
 #pragma once
+#include <atomic>
+#include <cassert>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <span>
 #include <thread>
+#include <vector>
 #include "ctpl.h"
+#include "skipjoin/source/block_list.hpp"
+#include "skipjoin/source/join_sink.hpp"
 
 
+/**
+ * Collects join output in one output list per task and merges the lists
+ * serially. See ParallelOutputCollector for per-worker buffers that are merged
+ * in parallel into a plain std::vector.
+ */
 template <typename OutputIterator, typename EventType>
 class ParallelOutputHelper
 {
@@ -19,19 +34,202 @@ public:
 		}
 	}
 
+	/**
+	 * Return an output iterator to a fresh output list. Safe to call from
+	 * several tasks at once.
+	 */
 	OutputIterator get_iterator()
 	{
+		std::lock_guard<std::mutex> guard(_lock);
 		_outputs.emplace_back();
 		return std::back_inserter(_outputs.back());
 	}
 
+	OutputIterator get_iterator(int /*worker*/)
+	{
+		return get_iterator();
+	}
+
 private:
+	std::mutex _lock;
 	std::list<std::vector<std::pair<EventType, EventType>>> _outputs;
 };
 
 
+/**
+ * Allocator that leaves the values created by resize (and the other operations
+ * that value-initialize) uninitialized, for vectors of trivial values that are
+ * overwritten right away.
+ */
+template <typename Type>
+struct UninitializedAllocator : std::allocator<Type>
+{
+	static_assert(std::is_trivially_destructible_v<Type>, "only trivial values can be left uninitialized");
+
+	using value_type = Type;
+
+	template <typename Other>
+	struct rebind
+	{
+		using other = UninitializedAllocator<Other>;
+	};
+
+	UninitializedAllocator() = default;
+	template <typename Other>
+	UninitializedAllocator(UninitializedAllocator<Other> const&) noexcept {}
+
+	template <typename Other>
+	void construct(Other*) noexcept {}
+
+	template <typename Other, typename... Args>
+	void construct(Other* pointer, Args&&... args)
+	{
+		::new (static_cast<void*>(pointer)) Other(std::forward<Args>(args)...);
+	}
+};
+
+
+/**
+ * Collects join output in one chunked buffer per worker. Every worker appends
+ * to its own buffer without synchronization; merge_output computes the offset
+ * of every buffer in the result and copies all buffers into it in parallel.
+ */
+template <typename EventType>
+class ParallelOutputCollector
+{
+public:
+	using OutputBuffer = block_list<std::pair<EventType, EventType>>;
+	using OutputIterator = std::back_insert_iterator<OutputBuffer>;
+
+	/* A merged output that does not initialize the new results when it grows
+	 * (see merge_output). */
+	using Result = std::vector<std::pair<EventType, EventType>, UninitializedAllocator<std::pair<EventType, EventType>>>;
+
+	ParallelOutputCollector(std::size_t num_workers)
+		: _buffers(std::max<std::size_t>(1u, num_workers)) {}
+
+	ParallelOutputCollector(ParallelOutputCollector&&) = delete;
+	ParallelOutputCollector(ParallelOutputCollector const& other) = delete;
+
+	/**
+	 * Return an output iterator to the buffer of the specified worker. Only
+	 * that worker may write to it. The collector must have been constructed
+	 * with at least as many workers as the pool that runs the join.
+	 */
+	OutputIterator get_iterator(int worker)
+	{
+		assert(worker >= 0 && (std::size_t)worker < _buffers.size());
+		return std::back_inserter(_buffers[worker].data);
+	}
+
+	/**
+	 * Return the number of collected join results.
+	 */
+	std::size_t size() const
+	{
+		std::size_t total = 0;
+		for (const auto& buffer : _buffers) {
+			total += buffer.data.size();
+		}
+		return total;
+	}
+
+	/**
+	 * Append all collected results to output, which can be any std::vector of
+	 * result pairs. The copies run in parallel, see below. Growing a vector
+	 * with the standard allocator zero-fills the new results first (serially);
+	 * a Result is grown without initialization.
+	 */
+	template <typename Allocator, typename Pool>
+	void merge_output(std::vector<std::pair<EventType, EventType>, Allocator>& output, Pool& pool)
+	{
+		auto offset = output.size();
+		output.resize(offset + size());
+		merge_output(std::span<std::pair<EventType, EventType>>(output).subspan(offset), pool);
+	}
+
+	/**
+	 * Copy all collected results to output, which must hold exactly size()
+	 * results (e.g., a preallocated result). The copies run as tasks on the
+	 * provided pool (see WorkStealingPoolHandler::wait), one per buffer, each
+	 * to the slice of output at the prefix sum of the preceding buffer sizes.
+	 */
+	template <typename Pool>
+	void merge_output(std::span<std::pair<EventType, EventType>> output, Pool& pool)
+	{
+		assert(output.size() == size());
+
+		std::size_t offset = 0;
+		for (auto& buffer : _buffers) {
+			if (!buffer.data.empty()) {
+				pool.append_task([output, &data = buffer.data, offset](int) {
+					std::copy(data.cbegin(), data.cend(), output.begin() + offset);
+				});
+			}
+			offset += buffer.data.size();
+		}
+		pool.wait();
+	}
+
+private:
+	/* Each buffer on its own cache line, the buffer bookkeeping changes on
+	 * every append. */
+	struct alignas(64) Buffer
+	{
+		OutputBuffer data;
+	};
+
+	std::vector<Buffer> _buffers;
+};
+
+
+/**
+ * Counts join results with one counter per worker, see count_sink. Nothing is
+ * materialized, hence there is nothing to merge.
+ */
+class ParallelCountCollector
+{
+public:
+	using OutputIterator = count_sink<std::size_t>;
+
+	ParallelCountCollector(std::size_t num_workers)
+		: _counts(std::max<std::size_t>(1u, num_workers)) {}
+
+	ParallelCountCollector(ParallelCountCollector&&) = delete;
+	ParallelCountCollector(ParallelCountCollector const& other) = delete;
+
+	OutputIterator get_iterator(int worker)
+	{
+		assert(worker >= 0 && (std::size_t)worker < _counts.size());
+		return OutputIterator(_counts[worker].count);
+	}
+
+	/**
+	 * Return the number of counted join results.
+	 */
+	std::size_t size() const
+	{
+		std::size_t total = 0;
+		for (const auto& counter : _counts) {
+			total += counter.count;
+		}
+		return total;
+	}
+
+private:
+	struct alignas(64) Counter
+	{
+		std::size_t count = 0;
+	};
+
+	std::vector<Counter> _counts;
+};
+
+
 class JoinTaskHandler {
 public:
+	virtual ~JoinTaskHandler() = default;
+
 	virtual void append_task(std::function<void(int)>&&) = 0;
 	virtual void join() = 0;
 };
@@ -92,4 +290,188 @@ public:
 private:
 	int _threads_count = 0;
 	std::vector<std::thread> _threads;
-};
\ No newline at end of file
+};
+
+
+/**
+ * Fixed-size pool in which every worker owns a deque of tasks. A worker pushes
+ * and pops tasks at the back of its own deque and, once that deque runs dry,
+ * steals from the front of the deques of the other workers. Each deque has its
+ * own lock, hence there is no lock shared by all workers. Tasks appended by a
+ * thread that is not a worker are distributed round-robin over the deques.
+ */
+class WorkStealingPoolHandler : public JoinTaskHandler
+{
+public:
+	WorkStealingPoolHandler(std::size_t num_threads)
+		: _workers(std::max<std::size_t>(1u, num_threads))
+	{
+		_threads.reserve(_workers.size());
+		for (std::size_t i = 0; i < _workers.size(); ++i) {
+			_threads.emplace_back([this, i]() { run_worker((int)i); });
+		}
+	}
+
+	WorkStealingPoolHandler(const WorkStealingPoolHandler&) = delete;
+	WorkStealingPoolHandler(WorkStealingPoolHandler&&) = delete;
+
+	~WorkStealingPoolHandler()
+	{
+		join();
+	}
+
+	void append_task(std::function<void(int)>&& func) override
+	{
+#ifdef _DEBUG_NO_PARALLEL
+		func(0);
+#else
+		std::size_t i = (_current_pool == this) ? (std::size_t)_current_worker
+			: _next_worker.fetch_add(1, std::memory_order_relaxed) % _workers.size();
+
+		_pending.fetch_add(1, std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> guard(_workers[i].lock);
+			_workers[i].tasks.emplace_back(std::move(func));
+		}
+
+		_signal.fetch_add(1, std::memory_order_release);
+		_signal.notify_one();
+#endif
+	}
+
+	/**
+	 * Wait until every appended task, including the tasks appended by other
+	 * tasks, has finished and stop the workers.
+	 */
+	void join() override
+	{
+		if (_threads.empty()) {
+			return;
+		}
+
+		wait();
+
+		_stopping.store(true);
+		_signal.fetch_add(1, std::memory_order_release);
+		_signal.notify_all();
+		for (auto& t : _threads) {
+			t.join();
+		}
+		_threads.clear();
+	}
+
+	/**
+	 * Wait until every appended task, including the tasks appended by other
+	 * tasks, has finished. Unlike join, the workers keep running, hence tasks
+	 * can be appended afterwards. Must not be called by a task.
+	 */
+	void wait()
+	{
+		for (auto pending = _pending.load(); pending != 0; pending = _pending.load()) {
+			_pending.wait(pending);
+		}
+	}
+
+	/**
+	 * Return the number of workers in the pool.
+	 */
+	std::size_t size() const
+	{
+		return _workers.size();
+	}
+
+private:
+	struct Worker
+	{
+		std::mutex lock;
+		std::deque<std::function<void(int)>> tasks;
+	};
+
+	void run_worker(int id)
+	{
+		_current_pool = this;
+		_current_worker = id;
+
+		std::function<void(int)> task;
+		while (true)
+		{
+			if (pop_task(id, task)) {
+				run_task(id, task);
+				continue;
+			}
+
+			/* Read the signal before checking the deques once more, such that
+			 * a task appended after the check always wakes us up. This check
+			 * waits for the locks of the other workers, such that a task is
+			 * not missed because its deque was locked at the time. */
+			auto signal = _signal.load(std::memory_order_acquire);
+			if (pop_task(id, task, true)) {
+				run_task(id, task);
+			}
+			else if (_stopping.load()) {
+				break;
+			}
+			else {
+				_signal.wait(signal);
+			}
+		}
+
+		_current_pool = nullptr;
+	}
+
+	void run_task(int id, std::function<void(int)>& task)
+	{
+		task(id);
+		task = nullptr;
+		if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			_pending.notify_all();
+		}
+	}
+
+	/**
+	 * Take a task from our own deque or steal one from another worker. The
+	 * deques of other workers are skipped while locked, unless blocking.
+	 */
+	bool pop_task(int id, std::function<void(int)>& task, bool blocking = false)
+	{
+		/* Newest task from our own deque first. */
+		{
+			auto& own = _workers[id];
+			std::lock_guard<std::mutex> guard(own.lock);
+			if (!own.tasks.empty()) {
+				task = std::move(own.tasks.back());
+				own.tasks.pop_back();
+				return true;
+			}
+		}
+
+		/* Steal the oldest task of another worker. */
+		for (std::size_t k = 1; k < _workers.size(); ++k) {
+			auto& victim = _workers[(id + k) % _workers.size()];
+			std::unique_lock<std::mutex> guard(victim.lock, std::defer_lock);
+			if (blocking) {
+				guard.lock();
+			}
+			else {
+				guard.try_lock();
+			}
+			if (guard.owns_lock() && !victim.tasks.empty()) {
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::vector<Worker> _workers;
+	std::vector<std::thread> _threads;
+
+	std::atomic<std::size_t> _next_worker = 0;
+	std::atomic<std::size_t> _pending = 0;
+	std::atomic<std::size_t> _signal = 0;
+	std::atomic<bool> _stopping = false;
+
+	inline static thread_local WorkStealingPoolHandler* _current_pool = nullptr;
+	inline static thread_local int _current_worker = 0;
+};
@@ -29,6 +29,10 @@
 
 #include <algorithm>
 
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
 /**
  * Three-way-merge algorithm that merges three sorted lists into a single sorted
  * list. On equal values (wuth respect to compare) list [first1, last1[ will\
@@ -71,4 +75,19 @@ OutIt merge_three_way(InIt1 first1, InIt1 last1,
     }
 }
 
+/**
+ * Hint the processor to fetch the cache line holding the provided address for
+ * reading. The address does not need to be valid: prefetching never faults.
+ */
+inline void prefetch_read(const void* address)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address, 0, 3);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,362 @@
+#ifndef INCLUDE_BINARY_DATASET_HPP
+#define INCLUDE_BINARY_DATASET_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "dataset.hpp"
+#include "interval.hpp"
+#include "interval_columns.hpp"
+#include "mapped_file.hpp"
+#include "parallel_dataset.hpp"
+
+/*
+ * Binary interval file format. A file holds a fixed-size header followed by the
+ * start-time column and the end-time column, each starting at a 64-byte aligned
+ * offset. Columns are either stored raw (one timestamp per event in native byte
+ * order) or delta-encoded. Delta-encoded columns hold the differences between
+ * consecutive start-times and the durations end - start, respectively, as
+ * zigzag LEB128 variable-length integers. Raw files can be used in-place via a
+ * memory mapping; delta-encoded files are smaller, but must be decoded.
+ */
+
+/**
+ * The encoding of the columns in a binary interval file.
+ */
+enum class column_encoding : std::uint8_t
+{
+    raw = 0,
+    delta = 1
+};
+
+/**
+ * The header of a binary interval file.
+ */
+struct binary_dataset_header
+{
+    static constexpr char magic_value[4] = {'S', 'K', 'J', 'I'};
+    static constexpr std::uint16_t current_version = 1;
+    static constexpr std::uint16_t byte_order_mark = 0x0102;
+    static constexpr std::uint64_t column_alignment = 64;
+
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t byte_order;
+    std::uint8_t timestamp_size;
+    column_encoding encoding;
+    std::uint8_t reserved[6];
+    std::uint64_t count;
+    std::uint64_t start_offset;
+    std::uint64_t start_size;
+    std::uint64_t end_offset;
+    std::uint64_t end_size;
+};
+static_assert(std::is_trivially_copyable<binary_dataset_header>::value, "header must be trivially copyable");
+
+/**
+ * Return true if the provided bytes start with the binary interval file magic.
+ */
+inline bool is_binary_dataset(const char* data, const std::size_t size)
+{
+    return size >= sizeof(binary_dataset_header::magic_value) &&
+           std::memcmp(data, binary_dataset_header::magic_value, sizeof(binary_dataset_header::magic_value)) == 0;
+}
+
+namespace binary_dataset_detail
+{
+    /**
+     * Append value as a LEB128 variable-length integer.
+     */
+    inline void put_varint(std::vector<char>& out, std::uint64_t value)
+    {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    /**
+     * Read a LEB128 variable-length integer from [first, last) and advance
+     * first. Throw an invalid_argument on truncated or overlong input.
+     */
+    inline std::uint64_t get_varint(const char*& first, const char* last)
+    {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (first == last) {
+                throw std::invalid_argument("binary dataset column is truncated");
+            }
+            auto byte = static_cast<unsigned char>(*first++);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        throw std::invalid_argument("binary dataset column holds an invalid integer");
+    }
+
+    /**
+     * Zigzag-encode the difference (modulo the range of UInt) between two
+     * timestamps, such that small negative differences remain small.
+     */
+    template<class UInt>
+    std::uint64_t zigzag(const UInt difference)
+    {
+        auto value = static_cast<std::int64_t>(static_cast<std::make_signed_t<UInt>>(difference));
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+    template<class UInt>
+    UInt unzigzag(const std::uint64_t value)
+    {
+        return static_cast<UInt>((value >> 1) ^ (~(value & 1) + 1));
+    }
+
+    /**
+     * Pad out with zero bytes until its size is a multiple of the alignment.
+     */
+    inline void pad(std::ostream& out, const std::uint64_t size)
+    {
+        static const char zeros[binary_dataset_header::column_alignment] = {};
+        auto padding = (binary_dataset_header::column_alignment - size % binary_dataset_header::column_alignment) %
+                       binary_dataset_header::column_alignment;
+        out.write(zeros, padding);
+    }
+
+    inline std::uint64_t align(const std::uint64_t offset)
+    {
+        auto a = binary_dataset_header::column_alignment;
+        return (offset + a - 1) / a * a;
+    }
+}
+
+/**
+ * Write the events in [first, last) to out in the binary interval file format
+ * using the provided column encoding. The output stream should be opened in
+ * binary mode.
+ */
+template<class InIt>
+void write_binary_events(std::ostream& out, InIt first, InIt last,
+                         const column_encoding encoding = column_encoding::raw)
+{
+    using namespace binary_dataset_detail;
+    using event = typename std::iterator_traits<InIt>::value_type;
+    using timestamp = typename event::unsigned_type;
+
+    /* Build both columns in memory: the sizes of delta-encoded columns are
+     * only known after encoding. */
+    std::vector<char> starts;
+    std::vector<char> ends;
+    std::uint64_t count = 0;
+    timestamp previous = 0;
+    for (; first != last; ++first, ++count) {
+        event current = *first;
+        if (encoding == column_encoding::raw) {
+            starts.insert(starts.end(), reinterpret_cast<const char*>(&current.start),
+                          reinterpret_cast<const char*>(&current.start) + sizeof(timestamp));
+            ends.insert(ends.end(), reinterpret_cast<const char*>(&current.end),
+                        reinterpret_cast<const char*>(&current.end) + sizeof(timestamp));
+        }
+        else {
+            put_varint(starts, zigzag<timestamp>(current.start - previous));
+            put_varint(ends, zigzag<timestamp>(current.end - current.start));
+            previous = current.start;
+        }
+    }
+
+    binary_dataset_header header{};
+    std::memcpy(header.magic, binary_dataset_header::magic_value, sizeof(header.magic));
+    header.version = binary_dataset_header::current_version;
+    header.byte_order = binary_dataset_header::byte_order_mark;
+    header.timestamp_size = sizeof(timestamp);
+    header.encoding = encoding;
+    header.count = count;
+    header.start_offset = align(sizeof(binary_dataset_header));
+    header.start_size = starts.size();
+    header.end_offset = align(header.start_offset + header.start_size);
+    header.end_size = ends.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    pad(out, sizeof(header));
+    out.write(starts.data(), starts.size());
+    pad(out, starts.size());
+    out.write(ends.data(), ends.size());
+    if (!out) {
+        throw std::invalid_argument("could not write binary dataset");
+    }
+}
+
+/**
+ * A memory-mapped binary interval file holding timestamps of type UInt. The
+ * header is validated on construction; throw an invalid_argument if the file is
+ * not a valid binary interval file for UInt.
+ *
+ * Files with raw columns are accessed in-place: begin() and end() iterate over
+ * the mapped columns without copying, such that the events can be directly fed
+ * to the bulk-load constructor of a stab_forest. Files with delta-encoded
+ * columns are decoded by read_events().
+ */
+template<class UInt>
+class binary_dataset
+{
+public:
+    using timestamp = UInt;
+    using event = interval<timestamp>;
+    using const_iterator = column_iterator<timestamp>;
+    using size_type = std::size_t;
+
+    /**
+     * Map and validate the binary interval file at the provided path.
+     */
+    explicit binary_dataset(const std::string& path) : file(path), header()
+    {
+        if (file.size() < sizeof(binary_dataset_header) || !is_binary_dataset(file.data(), file.size())) {
+            throw std::invalid_argument(path + " is not a binary dataset");
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.version != binary_dataset_header::current_version) {
+            throw std::invalid_argument(path + " has an unsupported binary dataset version");
+        }
+        if (header.byte_order != binary_dataset_header::byte_order_mark) {
+            throw std::invalid_argument(path + " was written with a different byte order");
+        }
+        if (header.timestamp_size != sizeof(timestamp)) {
+            throw std::invalid_argument(path + " holds timestamps of a different size");
+        }
+        if (header.encoding != column_encoding::raw && header.encoding != column_encoding::delta) {
+            throw std::invalid_argument(path + " has an unknown column encoding");
+        }
+        if (header.start_offset > file.size() || header.start_size > file.size() - header.start_offset ||
+            header.end_offset > file.size() || header.end_size > file.size() - header.end_offset ||
+            header.start_offset % alignof(timestamp) != 0 || header.end_offset % alignof(timestamp) != 0) {
+            throw std::invalid_argument(path + " has invalid column bounds");
+        }
+        if (header.encoding == column_encoding::raw &&
+            (header.start_size / sizeof(timestamp) != header.count || header.end_size / sizeof(timestamp) != header.count)) {
+            throw std::invalid_argument(path + " has invalid column sizes");
+        }
+        /* Every varint takes at least one byte. */
+        if (header.encoding == column_encoding::delta &&
+            (header.count > header.start_size || header.count > header.end_size)) {
+            throw std::invalid_argument(path + " has invalid column sizes");
+        }
+    }
+
+    /**
+     * Return the number of events in the file.
+     */
+    size_type size() const
+    {
+        return static_cast<size_type>(header.count);
+    }
+
+    /**
+     * Return the encoding of the columns.
+     */
+    column_encoding encoding() const
+    {
+        return header.encoding;
+    }
+
+    /**
+     * Return iterators to the begin and one-past-end of the mapped columns.
+     * Only valid for files with raw columns.
+     */
+    const_iterator begin() const
+    {
+        require_raw();
+        return const_iterator(start_column(), end_column());
+    }
+    const_iterator end() const
+    {
+        require_raw();
+        return const_iterator(start_column() + size(), end_column() + size());
+    }
+
+    /**
+     * Copy (decode) all events to the provided output iterator.
+     */
+    template<class OutputIterator>
+    OutputIterator copy_events(OutputIterator output) const
+    {
+        using namespace binary_dataset_detail;
+        if (header.encoding == column_encoding::raw) {
+            return std::copy(begin(), end(), output);
+        }
+
+        const char* starts = file.data() + header.start_offset;
+        const char* starts_end = starts + header.start_size;
+        const char* ends = file.data() + header.end_offset;
+        const char* ends_end = ends + header.end_size;
+        timestamp previous = 0;
+        for (std::uint64_t i = 0; i < header.count; ++i) {
+            timestamp start = previous + unzigzag<timestamp>(get_varint(starts, starts_end));
+            timestamp end = start + unzigzag<timestamp>(get_varint(ends, ends_end));
+            *output++ = event{start, end};
+            previous = start;
+        }
+        return output;
+    }
+
+    /**
+     * Return all events in the file.
+     */
+    std::vector<event> read_events() const
+    {
+        std::vector<event> data;
+        data.reserve(size());
+        copy_events(std::back_inserter(data));
+        return data;
+    }
+
+private:
+    void require_raw() const
+    {
+        if (header.encoding != column_encoding::raw) {
+            throw std::logic_error("binary dataset columns are not stored raw");
+        }
+    }
+
+    const timestamp* start_column() const
+    {
+        return reinterpret_cast<const timestamp*>(file.data() + header.start_offset);
+    }
+    const timestamp* end_column() const
+    {
+        return reinterpret_cast<const timestamp*>(file.data() + header.end_offset);
+    }
+
+    mapped_file file;
+    binary_dataset_header header;
+};
+
+/**
+ * Read the events from the file at the provided path, which is either a binary
+ * interval file or a text file holding (start, end)-pairs (see read_events). Text
+ * files are parsed in parallel (see read_events_parallel).
+ */
+template<class UInt>
+std::vector<interval<UInt>> load_events(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::invalid_argument("could not read data file " + path);
+    }
+    char magic[sizeof(binary_dataset_header::magic_value)] = {};
+    in.read(magic, sizeof(magic));
+    if (is_binary_dataset(magic, static_cast<std::size_t>(in.gcount()))) {
+        in.close();
+        return binary_dataset<UInt>(path).read_events();
+    }
+
+    in.close();
+    return read_events_parallel<UInt>(path);
+}
+
+#endif
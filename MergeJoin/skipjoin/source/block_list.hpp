@@ -40,7 +40,9 @@
  * stack-like append-semantics and high-performance value traversal. Internally,
  * the container is a list, in which each list element holds a block of at most
  * C values. The container guarantees a worst-case complexity of O(1) for LIFO
- * append/removal operations and high-performance traversal.
+ * append/removal operations and high-performance traversal. Values can also be
+ * removed from the front in O(1), in which case blocks are released as soon as
+ * all their values are removed.
  *
  * Block-lists provide strong stability guarantees with respect to pointers,
  * references, and iterators. Pointers and references to values stored in a
@@ -118,13 +120,16 @@ public:
 
 private:
     /* Pointer to the first list-block, the last list-block, and the number of
-     * elements in each block. All blocks before the last block are completely
-     * filled with C values. The last block is filled with only size() % C. Any
-     * blocks after last will only exists if the block-list shrunk, and these
-     * blocks will be entirely empty. */
+     * elements in each block. All blocks between the first block and the last
+     * block are completely filled with C values. The first block holds values
+     * starting at first_offset (non-zero only if values were removed from the
+     * front), the last block holds values up-to current_offset. Any blocks
+     * after last will only exists if the block-list shrunk, and these blocks
+     * will be entirely empty. */
     block_pointer first;
     block_pointer current;
     size_type data_size;
+    size_type first_offset;
     size_type current_offset;
 
 public:
@@ -132,7 +137,7 @@ public:
      * Default-construct: empty block-list.
      */
     block_list() : first(nullptr), current(nullptr),
-                   data_size(0), current_offset(0) { }
+                   data_size(0), first_offset(0), current_offset(0) { }
 
     /**
      * Move-construct.
@@ -147,7 +152,7 @@ public:
      */
     ~block_list()
     {
-        deconstruct_all(first, data_size, deconstruction_type());
+        deconstruct_all(first, first_offset, data_size, deconstruction_type());
         while (first != nullptr) {
             block_pointer pointer = first;
             first = first->next;
@@ -176,11 +181,11 @@ public:
      */
     iterator begin()
     {
-        return { first, 0 };
+        return { first, first_offset };
     }
     const_iterator begin() const
     {
-        return { first, 0 };
+        return { first, first_offset };
     }
     const_iterator cbegin() const
     {
@@ -188,14 +193,23 @@ public:
     }
 
     /**
-     * Return iterator to the end of the block-list.
+     * Return iterator to the end of the block-list. If the last block is full
+     * and followed by an (empty) block, then the end is the start of that
+     * block, as incrementing an iterator pointing to the last value moves into
+     * that block.
      */
     iterator end()
     {
+        if (current_offset == C && current->next != nullptr) {
+            return { current->next, 0 };
+        }
         return { current, current_offset };
     }
     const_iterator end() const
     {
+        if (current_offset == C && current->next != nullptr) {
+            return { current->next, 0 };
+        }
         return { current, current_offset };
     }
     const_iterator cend() const
@@ -280,6 +294,29 @@ public:
         --data_size;
     }
 
+    /**
+     * Remove the first value. Iterators, pointers, and references to the
+     * removed value are invalidated; the first block is released when all its
+     * values are removed.
+     */
+    void pop_front()
+    {
+        assert(data_size > 0);
+        deconstruct(first->values + first_offset, deconstruction_type());
+        ++first_offset;
+        --data_size;
+        if (first_offset == C && first != current) {
+            block_pointer next = first->next;
+            next->previous = nullptr;
+            ::operator delete(first);
+            first = next;
+            first_offset = 0;
+        }
+        if (data_size == 0) {
+            first_offset = current_offset = 0;
+        }
+    }
+
     /**
      * Return the size of the block-list.
      */
@@ -304,6 +341,7 @@ public:
         std::swap(other.first, first);
         std::swap(other.current, current);
         std::swap(other.data_size, data_size);
+        std::swap(other.first_offset, first_offset);
         std::swap(other.current_offset, current_offset);
     }
 
@@ -357,21 +395,20 @@ private:
     }
 
     /**
-     * Deconstruct num values, start at the values in the first block
+     * Deconstruct num values, start at the value at offset in the first block
      * (deconstruction of the values is not necessary).
      */
-    static void deconstruct_all(const block_pointer first, const size_type num, const std::true_type&)
+    static void deconstruct_all(const block_pointer, const size_type, const size_type, const std::true_type&)
     {
     }
 
     /**
-     * Deconstruct num values, start at the values in the first block
+     * Deconstruct num values, start at the value at offset in the first block
      * (deconstruction of the values is necessary).
      */
-    static void deconstruct_all(const block_pointer first, const size_type num, const std::false_type&)
+    static void deconstruct_all(const block_pointer first, size_type offset, const size_type num, const std::false_type&)
     {
         block_pointer pointer = first;
-        size_type offset = 0;
         size_type deleted = 0;
         while (deleted < num) {
             deconstruct(pointer->values + offset, deconstruction_type());
@@ -387,7 +424,7 @@ private:
     /**
      * Deconstruct a value (deconstruction of the values is not necessary).
      */
-    static void deconstruct(const pointer pointer, const std::true_type&)
+    static void deconstruct(const pointer, const std::true_type&)
     {
     }
 
@@ -0,0 +1,99 @@
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+
+#include "block_list.hpp"
+
+/**
+ * Check the block-list operations that use the spare blocks left behind by
+ * pop_back and the blocks released by pop_front:
+ *
+ *  1. a full last block followed by a spare block: end() is the start of the
+ *     spare block, hence incrementing an iterator to the last value reaches
+ *     end(), and end() is a valid position to append at;
+ *  2. removing all values from the front and refilling the block-list.
+ *
+ * Return the number of failed checks.
+ *
+ *   check_block_list
+ */
+int main()
+{
+    constexpr std::size_t C = 4;
+    int failures = 0;
+    auto check = [&failures](const bool condition, const char* description) {
+        if (!condition) {
+            std::cout << "failed: " << description << std::endl;
+            ++failures;
+        }
+    };
+    auto holds = [](const block_list<int, C>& list, int first, int last) {
+        if (list.size() != static_cast<std::size_t>(last - first) ||
+            std::distance(list.cbegin(), list.cend()) != last - first) {
+            return false;
+        }
+        for (auto value : list) {
+            if (value != first++) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    {
+        block_list<int, C> list;
+        for (int i = 0; i < static_cast<int>(C) + 1; ++i) {
+            list.push_back(i);
+        }
+        list.pop_back();
+        check(holds(list, 0, C), "full last block followed by a spare block");
+        check(std::next(list.cbegin(), C) == list.cend(), "iterator past the last value is end()");
+        check(list.back() == static_cast<int>(C) - 1, "back() before a spare block");
+
+        auto end = list.cend();
+        list.push_back(C);
+        check(list.repoint_iterator(end) != list.cend() && *list.repoint_iterator(end) == static_cast<int>(C),
+              "end() before a spare block points to the next appended value");
+        check(holds(list, 0, C + 1), "append into a spare block");
+    }
+
+    {
+        block_list<int, C> list;
+        for (int i = 0; i < static_cast<int>(3 * C) + 1; ++i) {
+            list.push_back(i);
+        }
+        for (int i = 0; i < static_cast<int>(3 * C) + 1; ++i) {
+            list.pop_front();
+            check(holds(list, i + 1, 3 * C + 1), "pop_front");
+        }
+        check(list.empty() && list.cbegin() == list.cend(), "pop_front down to empty");
+
+        for (int i = 0; i < static_cast<int>(2 * C) + 1; ++i) {
+            list.push_back(i);
+        }
+        check(holds(list, 0, 2 * C + 1), "refill after pop_front down to empty");
+        check(list.front() == 0 && list.back() == static_cast<int>(2 * C), "front() and back() after refill");
+    }
+
+    {
+        block_list<int, C> list;
+        for (int i = 0; i < static_cast<int>(C) + 1; ++i) {
+            list.push_back(i);
+        }
+        list.pop_back();
+        for (int i = 0; i < static_cast<int>(C); ++i) {
+            list.pop_front();
+        }
+        check(list.empty() && list.cbegin() == list.cend(), "pop_front down to empty before a spare block");
+
+        for (int i = 0; i < static_cast<int>(C) + 1; ++i) {
+            list.push_back(i);
+        }
+        check(holds(list, 0, C + 1), "refill after pop_front down to empty before a spare block");
+    }
+
+    if (failures == 0) {
+        std::cout << "block_list: all checks passed" << std::endl;
+    }
+    return failures;
+}
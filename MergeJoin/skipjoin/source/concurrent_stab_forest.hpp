@@ -0,0 +1,639 @@
+#ifndef INCLUDE_CONCURRENT_STAB_FOREST_HPP
+#define INCLUDE_CONCURRENT_STAB_FOREST_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "interval.hpp"
+#include "stab_forest.hpp"
+
+/*
+ * Single-writer/multi-reader stab-forests. One writer thread appends events to
+ * a concurrent_stab_forest and, now and then, publishes the current state as a
+ * read-only stab_forest_snapshot. Reader threads pin the most recently
+ * published snapshot and query it without taking locks, while the writer keeps
+ * appending. Snapshots that are no longer published are reclaimed by the writer
+ * once no reader has them pinned (epoch-based reclamation).
+ *
+ * Readers never touch state the writer modifies after publication. Events are
+ * stored in contiguous storage that is shared with the snapshots: appends only
+ * write past the events of published snapshots, and growing the storage moves
+ * the events to new storage, leaving the old storage to the snapshots that
+ * refer to it. Stab-tree nodes are never moved (they are stored in block-lists)
+ * and are not modified after they have become part of a stab-tree. The
+ * forest-points are the only part of the index that is modified (or removed)
+ * by merges; every snapshot holds its own copy of the forest-points.
+ */
+
+/**
+ * Minimal append-only list-like container with contiguous storage held by a
+ * shared pointer. When the storage is full, the values are copied to storage
+ * of twice the size; the old storage remains valid for as long as it is shared.
+ */
+template <class Type>
+class shared_array_list
+{
+public:
+    using value_type = Type;
+    using size_type = std::size_t;
+    using const_iterator = const value_type *;
+    using storage_type = std::shared_ptr<value_type[]>;
+
+    /**
+     * Default-construct: empty list.
+     */
+    shared_array_list() : storage(), data_size(0), capacity(0) {}
+
+    /**
+     * Return iterators to the begin and one-past-end of the list.
+     */
+    const_iterator cbegin() const
+    {
+        return storage.get();
+    }
+    const_iterator cend() const
+    {
+        return storage.get() + data_size;
+    }
+
+    /**
+     * Return the last value in the list.
+     */
+    const value_type &back() const
+    {
+        return storage[data_size - 1];
+    }
+
+    /**
+     * Return true if the list is empty.
+     */
+    bool empty() const
+    {
+        return data_size == 0;
+    }
+
+    /**
+     * Return the size of the list.
+     */
+    size_type size() const
+    {
+        return data_size;
+    }
+
+    /**
+     * Make sure that the list can hold n values without growing the storage.
+     */
+    void reserve(const size_type n)
+    {
+        if (capacity < n)
+        {
+            storage_type next(new value_type[n]);
+            std::copy(cbegin(), cend(), next.get());
+            storage = std::move(next);
+            capacity = n;
+        }
+    }
+
+    /**
+     * Construct-and-append value to the end of the list.
+     */
+    template <class... Args>
+    const value_type &emplace_back(Args &&...args)
+    {
+        if (data_size == capacity)
+        {
+            reserve(std::max<size_type>(64, 2 * capacity));
+        }
+        storage[data_size] = value_type{std::forward<Args>(args)...};
+        return storage[data_size++];
+    }
+
+    /**
+     * Return the storage holding the values.
+     */
+    const storage_type &shared_storage() const
+    {
+        return storage;
+    }
+
+private:
+    storage_type storage;
+    size_type data_size;
+    size_type capacity;
+};
+
+/**
+ * Use a shared_array_list to represent the event-list, such that snapshots can
+ * share the events with the stab-forest. As with vector_event_list, we use
+ * indices as stable pointers.
+ */
+template <class TimeStampType>
+class shared_event_list : public basic_event_list<shared_array_list<interval<TimeStampType>>>
+{
+protected:
+    using bel = basic_event_list<shared_array_list<interval<TimeStampType>>>;
+    using event_list_type = typename bel::event_list_type;
+    using const_iterator = typename bel::const_iterator;
+    using stable_event_pointer = typename event_list_type::size_type;
+
+    /**
+     * Default-constructor.
+     */
+    shared_event_list() : bel() {}
+
+    /**
+     * Return a stable pointer pointing to the same element as the provided
+     * iterator.
+     */
+    stable_event_pointer stabilize_iterator(const const_iterator it) const
+    {
+        return std::distance(this->cbegin(), it);
+    }
+
+    /**
+     * Return an iterator pointing to the same element as the provided
+     * stable pointer.
+     */
+    const_iterator unstabilize_pointer(const stable_event_pointer p) const
+    {
+        return this->cbegin() + p;
+    }
+};
+
+/**
+ * Read-only state of a concurrent stab-forest at the moment of publication:
+ * the events appended up-to that moment, the forest-points, and the tail
+ * pointer. Answers stab_search and stab_forward_search exactly as the
+ * stab-forest did at the moment of publication (using the same navigation as
+ * stab_forest).
+ */
+template <class TimeStampType>
+class stab_forest_snapshot : private stab_navigation<TimeStampType>
+{
+public:
+    using stab_forest_type = stab_forest_snapshot<TimeStampType>;
+    using source_forest_type = stab_forest<TimeStampType, shared_event_list>;
+
+    using timestamp = typename source_forest_type::timestamp;
+    using event = typename source_forest_type::event;
+    using const_iterator = typename source_forest_type::const_iterator;
+    using stable_event_pointer = typename source_forest_type::stable_event_pointer;
+    using size_type = typename source_forest_type::size_type;
+
+    /* The stab-forward helper. */
+    template <class OutputIterator, class JumpPolicy>
+    using stab_forward_helper = basic_stab_forward_helper<stab_forest_type, OutputIterator, JumpPolicy>;
+
+    /**
+     * Take a snapshot of the provided stab-forest. Copies the forest-points
+     * (including their max-lists), shares the events and the stab-trees.
+     */
+    explicit stab_forest_snapshot(const source_forest_type &forest) : storage(forest.event_list.shared_storage()),
+                                                                      event_list{forest.cbegin(), forest.cend()},
+                                                                      index(), tail_pointer(forest.tail_pointer),
+                                                                      min_key(forest.min_key)
+    {
+        index.reserve(forest.index.size());
+        for (auto &fp : forest.index)
+        {
+            size_type ml_size = fp.ll_size + fp.nll_size;
+            auto &copy = index.emplace_back(fp.nkey, fp.dkey, fp.left_ptr, nullptr, fp.height,
+                                            fp.data_begin, fp.data_end, fp.nll_size, fp.ll_size, ml_size);
+            std::copy(fp.ll_raw_data.data(), fp.ll_raw_data.data() + ml_size, copy.ll_raw_data.data());
+        }
+        for (size_type i = 1; i < index.size(); ++i)
+        {
+            index[i - 1].right_ptr = &index[i];
+        }
+    }
+
+    /**
+     * Return iterators to the begin and one-past-end of the event-list.
+     */
+    const_iterator begin() const
+    {
+        return event_list.cbegin();
+    }
+    const_iterator cbegin() const
+    {
+        return event_list.cbegin();
+    }
+    const_iterator end() const
+    {
+        return event_list.cend();
+    }
+    const_iterator cend() const
+    {
+        return event_list.cend();
+    }
+
+    /**
+     * Return true if the snapshot does not hold data.
+     */
+    bool empty() const
+    {
+        return event_list.empty();
+    }
+
+    /**
+     * Return the number of events in the snapshot.
+     */
+    size_type size() const
+    {
+        return event_list.size();
+    }
+
+    /**
+     * Perform a stab and search, see stab_forest::stab_search.
+     */
+    template <class OutputIterator>
+    const_iterator stab_search(const timestamp value, OutputIterator output) const
+    {
+        stab_operations<OutputIterator> operations{*this, output};
+        navigate_index(value, operations);
+        return operations.next_it;
+    }
+
+    /**
+     * Return a stab-forward helper, see stab_forest::stab_forward_search.
+     */
+    template <class OutputIterator, class JumpPolicy>
+    stab_forward_helper<OutputIterator, JumpPolicy> stab_forward_search(OutputIterator output,
+                                                                        const JumpPolicy &policy) const
+    {
+        return stab_forward_helper<OutputIterator, JumpPolicy>{*this, output, policy};
+    }
+
+    template <class OutputIterator, class JumpPolicy>
+    std::shared_ptr<stab_forward_helper<OutputIterator, JumpPolicy>> stab_forward_search_shared(OutputIterator output,
+        const JumpPolicy &policy) const
+    {
+        return std::shared_ptr<stab_forward_helper<OutputIterator, JumpPolicy>>(new stab_forward_helper<OutputIterator, JumpPolicy>(*this, output, policy));
+    }
+
+    /**
+     * Return the height of the index.
+     */
+    size_type index_height() const
+    {
+        return (index.empty()) ? 0 : index.front().height;
+    }
+
+private:
+    using navigation = stab_navigation<TimeStampType>;
+
+    using navigation::nll_sa_begin;
+    using navigation::nll_sa_end;
+    using navigation::dll_ed_begin;
+    using navigation::dll_ed_end;
+    using navigation::nll_ed_begin;
+    using navigation::nll_ed_end;
+    using navigation::copy_start_asc;
+    using navigation::copy_end_dec;
+    using navigation::navigate_stab_tree_node;
+
+    template <class StabForest, class OutputIterator, class JumpPolicy>
+    friend class basic_stab_forward_helper;
+    template <class StabForest, class OutputIterator>
+    friend struct basic_stab_operations;
+
+    using stab_tree_node = typename source_forest_type::stab_tree_node;
+
+    template <class OutputIterator>
+    using stab_operations = basic_stab_operations<stab_forest_type, OutputIterator>;
+
+    /**
+     * The published events, providing the list operations the stab-forward
+     * helper uses on the event-list.
+     */
+    struct event_range
+    {
+        const_iterator first;
+        const_iterator last;
+
+        const_iterator cbegin() const { return first; }
+        const_iterator cend() const { return last; }
+        const event &back() const { return *(last - 1); }
+        bool empty() const { return first == last; }
+        size_type size() const { return last - first; }
+    };
+
+    /**
+     * Query and navigate the snapshot using the index (see
+     * stab_navigation::navigate_index).
+     */
+    template <class NavigateOperations, class... Other>
+    void navigate_index(const timestamp value,
+                        NavigateOperations &op, Other &...other) const
+    {
+        navigation::template navigate_index<stab_tree_node>(index, min_key, value, op, other...);
+    }
+
+    /**
+     * Return an iterator pointing to the event with the provided index.
+     */
+    const_iterator unstabilize_pointer(const stable_event_pointer p) const
+    {
+        return event_list.cbegin() + p;
+    }
+
+    /* The storage holding the events (kept alive for this snapshot). */
+    typename shared_array_list<event>::storage_type storage;
+
+    /* The events. */
+    event_range event_list;
+
+    /* The copies of the forest-points. */
+    std::vector<stab_tree_node> index;
+
+    /* The tail pointer. */
+    stable_event_pointer tail_pointer;
+
+    /* The start-time of the first event in the event list. */
+    timestamp min_key;
+};
+
+/**
+ * Stab-forest that is appended to by a single writer thread while any number
+ * of reader threads query published snapshots of it. The writer appends with
+ * append_event and makes the appended events visible to readers with publish.
+ * Publishing copies the forest-points and their max-lists (which hold the
+ * events of each stab-tree that are still active after the stab-tree); the
+ * events and stab-trees are shared. A reader registers once (register_reader)
+ * and pins the current snapshot for the duration of each query (reader::pin);
+ * pinning and unpinning are a few atomic operations without locks. Snapshots
+ * that are replaced are reclaimed by publish once no reader has them pinned.
+ *
+ * The number of concurrently registered readers is fixed on construction. The
+ * concurrent stab-forest must outlive its readers.
+ */
+template <class TimeStampType>
+class concurrent_stab_forest
+{
+public:
+    using stab_forest_type = stab_forest<TimeStampType, shared_event_list>;
+    using snapshot_type = stab_forest_snapshot<TimeStampType>;
+
+    using timestamp = typename stab_forest_type::timestamp;
+    using event = typename stab_forest_type::event;
+    using size_type = typename stab_forest_type::size_type;
+
+private:
+    /**
+     * The slot in which a reader announces the epoch in which it pinned a
+     * snapshot (zero if the reader has nothing pinned).
+     */
+    struct alignas(64) reader_slot
+    {
+        std::atomic<std::uint64_t> epoch{0};
+        std::atomic<bool> claimed{false};
+    };
+
+public:
+    class reader;
+
+    /**
+     * A snapshot pinned by a reader: the snapshot is not reclaimed until the
+     * pinned snapshot is released (on destruction).
+     */
+    class pinned_snapshot
+    {
+    public:
+        /**
+         * Move-constructor.
+         */
+        pinned_snapshot(pinned_snapshot &&other) : slot(std::exchange(other.slot, nullptr)),
+                                                   snapshot(other.snapshot) {}
+
+        /**
+         * No copy-constructor.
+         */
+        pinned_snapshot(const pinned_snapshot &other) = delete;
+
+        /**
+         * No assignment.
+         */
+        pinned_snapshot &operator=(const pinned_snapshot &other) = delete;
+
+        /**
+         * Destructor: unpin the snapshot.
+         */
+        ~pinned_snapshot()
+        {
+            if (slot != nullptr)
+            {
+                slot->epoch.store(0, std::memory_order_release);
+            }
+        }
+
+        /**
+         * Access the snapshot.
+         */
+        const snapshot_type &operator*() const
+        {
+            return *snapshot;
+        }
+        const snapshot_type *operator->() const
+        {
+            return snapshot;
+        }
+
+    private:
+        pinned_snapshot(reader_slot *slot, const snapshot_type *snapshot) : slot(slot), snapshot(snapshot) {}
+
+        friend class reader;
+
+        reader_slot *slot;
+        const snapshot_type *snapshot;
+    };
+
+    /**
+     * A registered reader. Each reader is used by one thread at a time and pins
+     * at most one snapshot at a time.
+     */
+    class reader
+    {
+    public:
+        /**
+         * Move-constructor.
+         */
+        reader(reader &&other) : forest(other.forest), slot(std::exchange(other.slot, nullptr)) {}
+
+        /**
+         * No copy-constructor.
+         */
+        reader(const reader &other) = delete;
+
+        /**
+         * No assignment.
+         */
+        reader &operator=(const reader &other) = delete;
+
+        /**
+         * Destructor: unregister the reader.
+         */
+        ~reader()
+        {
+            if (slot != nullptr)
+            {
+                slot->claimed.store(false, std::memory_order_release);
+            }
+        }
+
+        /**
+         * Pin and return the most recently published snapshot. The reader
+         * announces the epoch in which it started reading before it loads the
+         * snapshot, such that the writer never reclaims a snapshot the reader
+         * can have loaded.
+         */
+        pinned_snapshot pin() const
+        {
+            assert(slot->epoch.load(std::memory_order_relaxed) == 0);
+            slot->epoch.store(forest->epoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+            return pinned_snapshot(slot, forest->current.load(std::memory_order_seq_cst));
+        }
+
+    private:
+        reader(const concurrent_stab_forest *forest, reader_slot *slot) : forest(forest), slot(slot) {}
+
+        friend class concurrent_stab_forest;
+
+        const concurrent_stab_forest *forest;
+        reader_slot *slot;
+    };
+
+    /**
+     * Construct an empty concurrent stab-forest supporting at most max_readers
+     * registered readers. An (empty) snapshot is published immediately.
+     */
+    explicit concurrent_stab_forest(const size_type max_readers = 64) : forest(), slots(new reader_slot[max_readers]),
+                                                                        max_readers(max_readers), epoch(1),
+                                                                        current(new snapshot_type(forest)), retired() {}
+
+    /**
+     * No copy-constructor.
+     */
+    concurrent_stab_forest(const concurrent_stab_forest &other) = delete;
+
+    /**
+     * No assignment.
+     */
+    concurrent_stab_forest &operator=(const concurrent_stab_forest &other) = delete;
+
+    /**
+     * Destructor. No reader may have a snapshot pinned.
+     */
+    ~concurrent_stab_forest()
+    {
+        delete current.load(std::memory_order_relaxed);
+        for (auto &r : retired)
+        {
+            delete r.second;
+        }
+    }
+
+    /**
+     * Append an event (writer only), see stab_forest::append_event. The event
+     * is not visible to readers until the next publish.
+     */
+    void append_event(const event current)
+    {
+        forest.append_event(current);
+    }
+
+    void append_event(const timestamp start, const timestamp end)
+    {
+        forest.append_event(start, end);
+    }
+
+    /**
+     * Publish the current state of the stab-forest to the readers (writer
+     * only) and reclaim the snapshots that are no longer pinned.
+     */
+    void publish()
+    {
+        auto next = new snapshot_type(forest);
+        auto old = current.exchange(next, std::memory_order_seq_cst);
+        retired.emplace_back(epoch.fetch_add(1, std::memory_order_seq_cst), old);
+        reclaim();
+    }
+
+    /**
+     * Return the stab-forest holding all appended events (writer only).
+     */
+    const stab_forest_type &writer_forest() const
+    {
+        return forest;
+    }
+
+    /**
+     * Register a reader; throw a runtime_error if max_readers readers are
+     * registered already.
+     */
+    reader register_reader() const
+    {
+        for (size_type i = 0; i < max_readers; ++i)
+        {
+            bool expected = false;
+            if (!slots[i].claimed.load(std::memory_order_relaxed) &&
+                slots[i].claimed.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                return reader(this, &slots[i]);
+            }
+        }
+        throw std::runtime_error("too many concurrent stab-forest readers");
+    }
+
+private:
+    /**
+     * Delete the retired snapshots that no reader can have pinned: a snapshot
+     * retired in epoch e can only be pinned by readers that announced an epoch
+     * at-or-before e.
+     */
+    void reclaim()
+    {
+        auto min_epoch = std::numeric_limits<std::uint64_t>::max();
+        for (size_type i = 0; i < max_readers; ++i)
+        {
+            auto e = slots[i].epoch.load(std::memory_order_seq_cst);
+            if (e != 0)
+            {
+                min_epoch = std::min(min_epoch, e);
+            }
+        }
+
+        auto keep = std::partition(retired.begin(), retired.end(),
+                                   [min_epoch](const auto &r) { return min_epoch <= r.first; });
+        for (auto it = keep; it != retired.end(); ++it)
+        {
+            delete it->second;
+        }
+        retired.erase(keep, retired.end());
+    }
+
+    /* The stab-forest appended to by the writer. */
+    stab_forest_type forest;
+
+    /* The reader slots. */
+    std::unique_ptr<reader_slot[]> slots;
+    size_type max_readers;
+
+    /* The current epoch, incremented by every publish. */
+    std::atomic<std::uint64_t> epoch;
+
+    /* The most recently published snapshot. */
+    std::atomic<const snapshot_type *> current;
+
+    /* The replaced snapshots and the epoch in which they were replaced. */
+    std::vector<std::pair<std::uint64_t, const snapshot_type *>> retired;
+};
+
+#endif
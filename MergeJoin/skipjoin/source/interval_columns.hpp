@@ -0,0 +1,250 @@
+#ifndef INCLUDE_INTERVAL_COLUMNS_HPP
+#define INCLUDE_INTERVAL_COLUMNS_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "interval.hpp"
+
+/**
+ * Random-access iterator over intervals stored as two columns: one array of
+ * start-times and one array of end-times. Dereferencing yields the interval by
+ * value. The arrow operator only refers to both columns, hence it->start reads
+ * the start-time column only.
+ */
+template <class TimeStampType>
+class column_iterator
+{
+public:
+    using timestamp = TimeStampType;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = interval<timestamp>;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type;
+
+    /**
+     * Result of the arrow operator.
+     */
+    struct arrow
+    {
+        const timestamp &start;
+        const timestamp &end;
+
+        const arrow *operator->() const
+        {
+            return this;
+        }
+    };
+    using pointer = arrow;
+
+    /**
+     * Default-construct.
+     */
+    column_iterator() : start_pointer(nullptr), end_pointer(nullptr) {}
+
+    /**
+     * Construct an iterator pointing to the start-time and end-time at the
+     * provided positions in the columns.
+     */
+    column_iterator(const timestamp *start_pointer, const timestamp *end_pointer) : start_pointer(start_pointer), end_pointer(end_pointer) {}
+
+    /**
+     * Return the position in the start-time column. Allows scans over the
+     * start-times only (see simd_scan.hpp).
+     */
+    const timestamp *start_data() const
+    {
+        return start_pointer;
+    }
+
+    /**
+     * Read values.
+     */
+    reference operator*() const
+    {
+        return value_type{*start_pointer, *end_pointer};
+    }
+    pointer operator->() const
+    {
+        return arrow{*start_pointer, *end_pointer};
+    }
+    reference operator[](const difference_type n) const
+    {
+        return value_type{start_pointer[n], end_pointer[n]};
+    }
+
+    /**
+     * Movement.
+     */
+    column_iterator &operator++()
+    {
+        ++start_pointer;
+        ++end_pointer;
+        return *this;
+    }
+    column_iterator operator++(int)
+    {
+        auto it(*this);
+        ++*this;
+        return it;
+    }
+    column_iterator &operator--()
+    {
+        --start_pointer;
+        --end_pointer;
+        return *this;
+    }
+    column_iterator operator--(int)
+    {
+        auto it(*this);
+        --*this;
+        return it;
+    }
+    column_iterator &operator+=(const difference_type n)
+    {
+        start_pointer += n;
+        end_pointer += n;
+        return *this;
+    }
+    column_iterator &operator-=(const difference_type n)
+    {
+        start_pointer -= n;
+        end_pointer -= n;
+        return *this;
+    }
+    friend column_iterator operator+(column_iterator it, const difference_type n)
+    {
+        return it += n;
+    }
+    friend column_iterator operator+(const difference_type n, column_iterator it)
+    {
+        return it += n;
+    }
+    friend column_iterator operator-(column_iterator it, const difference_type n)
+    {
+        return it -= n;
+    }
+    friend difference_type operator-(const column_iterator &lhs, const column_iterator &rhs)
+    {
+        return lhs.start_pointer - rhs.start_pointer;
+    }
+
+    /**
+     * Iterator comparisons.
+     */
+    friend bool operator==(const column_iterator &lhs, const column_iterator &rhs)
+    {
+        return lhs.start_pointer == rhs.start_pointer;
+    }
+    friend bool operator!=(const column_iterator &lhs, const column_iterator &rhs)
+    {
+        return lhs.start_pointer != rhs.start_pointer;
+    }
+    friend bool operator<(const column_iterator &lhs, const column_iterator &rhs)
+    {
+        return lhs.start_pointer < rhs.start_pointer;
+    }
+    friend bool operator>(const column_iterator &lhs, const column_iterator &rhs)
+    {
+        return lhs.start_pointer > rhs.start_pointer;
+    }
+    friend bool operator<=(const column_iterator &lhs, const column_iterator &rhs)
+    {
+        return lhs.start_pointer <= rhs.start_pointer;
+    }
+    friend bool operator>=(const column_iterator &lhs, const column_iterator &rhs)
+    {
+        return lhs.start_pointer >= rhs.start_pointer;
+    }
+
+private:
+    const timestamp *start_pointer;
+    const timestamp *end_pointer;
+};
+
+/**
+ * Append-only list of intervals stored as a start-time column and an end-time
+ * column (structure-of-arrays). Provides the container operations used by the
+ * stab-forest event-lists.
+ */
+template <class TimeStampType>
+class interval_columns
+{
+public:
+    using timestamp = TimeStampType;
+    using value_type = interval<timestamp>;
+    using const_iterator = column_iterator<timestamp>;
+    using size_type = std::size_t;
+
+    /**
+     * Return iterators to the begin and the one-past-end of the list.
+     */
+    const_iterator begin() const
+    {
+        return cbegin();
+    }
+    const_iterator cbegin() const
+    {
+        return const_iterator(starts.data(), ends.data());
+    }
+    const_iterator end() const
+    {
+        return cend();
+    }
+    const_iterator cend() const
+    {
+        return const_iterator(starts.data() + starts.size(), ends.data() + ends.size());
+    }
+
+    /**
+     * Return true if the list is empty.
+     */
+    bool empty() const
+    {
+        return starts.empty();
+    }
+
+    /**
+     * Return the number of intervals in the list.
+     */
+    size_type size() const
+    {
+        return starts.size();
+    }
+
+    /**
+     * Return the last interval in the list.
+     */
+    value_type back() const
+    {
+        return value_type{starts.back(), ends.back()};
+    }
+
+    /**
+     * Append an interval.
+     */
+    void emplace_back(const value_type &value)
+    {
+        starts.push_back(value.start);
+        ends.push_back(value.end);
+    }
+    void push_back(const value_type &value)
+    {
+        emplace_back(value);
+    }
+
+    /**
+     * Reserve space for n intervals.
+     */
+    void reserve(const size_type n)
+    {
+        starts.reserve(n);
+        ends.reserve(n);
+    }
+
+private:
+    std::vector<timestamp> starts;
+    std::vector<timestamp> ends;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef INCLUDE_JOIN_SINK_HPP
+#define INCLUDE_JOIN_SINK_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include "temporal_join.hpp"
+
+/**
+ * Join sinks are output iterators for the join algorithms that aggregate the
+ * join results instead of storing them. Like std::back_insert_iterator, a sink
+ * only points to the aggregate, hence copies of a sink update the same value.
+ *
+ * A sink can provide join_range<Join>(event, first, last), which is called by
+ * stab_result_join with the complete range [first, last) of events that join
+ * with event. The range is found with a binary search, hence sinks that only
+ * need the size of the range never visit the individual events.
+ */
+
+/**
+ * Count the number of join results.
+ */
+template <class Count = std::size_t>
+class count_sink
+{
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    explicit count_sink(Count &count) : count(&count) {}
+
+    count_sink &operator*() { return *this; }
+    count_sink &operator++() { return *this; }
+    count_sink &operator++(int) { return *this; }
+
+    template <class Pair>
+    count_sink &operator=(const Pair &)
+    {
+        ++*count;
+        return *this;
+    }
+
+    template <class Join, class Event, class ConstIterator>
+    void join_range(const Event &, ConstIterator first, ConstIterator last)
+    {
+        *count += std::distance(first, last);
+    }
+
+private:
+    Count *count;
+};
+
+/**
+ * Count the number of join results per left-hand side event. Counts are added
+ * to a map-like container (e.g., std::map with interval::start_end_compare())
+ * keyed on the left-hand side event.
+ */
+template <class Map>
+class per_key_count_sink
+{
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    explicit per_key_count_sink(Map &counts) : counts(&counts) {}
+
+    per_key_count_sink &operator*() { return *this; }
+    per_key_count_sink &operator++() { return *this; }
+    per_key_count_sink &operator++(int) { return *this; }
+
+    template <class Pair>
+    per_key_count_sink &operator=(const Pair &result)
+    {
+        ++(*counts)[result.first];
+        return *this;
+    }
+
+    template <class Join, class Event, class ConstIterator>
+    void join_range(const Event &event, ConstIterator first, ConstIterator last)
+    {
+        /* The event is the left-hand side: a single update. Otherwise, every
+         * event in the range is a distinct left-hand side event. */
+        if constexpr (std::is_same_v<Join, temporal_join_details::join_1>)
+        {
+            if (first != last)
+            {
+                (*counts)[event] += std::distance(first, last);
+            }
+        }
+        else
+        {
+            for (; first != last; ++first)
+            {
+                ++(*counts)[*first];
+            }
+        }
+    }
+
+private:
+    Map *counts;
+};
+
+/**
+ * Sum the length of the overlap, end-time minus start-time of the intersection,
+ * of all join results.
+ */
+template <class Sum>
+class overlap_sum_sink
+{
+public:
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    explicit overlap_sum_sink(Sum &sum) : sum(&sum) {}
+
+    overlap_sum_sink &operator*() { return *this; }
+    overlap_sum_sink &operator++() { return *this; }
+    overlap_sum_sink &operator++(int) { return *this; }
+
+    template <class Pair>
+    overlap_sum_sink &operator=(const Pair &result)
+    {
+        *sum += std::min(result.first.end, result.second.end) - std::max(result.first.start, result.second.start);
+        return *this;
+    }
+
+private:
+    Sum *sum;
+};
+
+/**
+ * Helper functions to construct sinks.
+ */
+template <class Count>
+count_sink<Count> make_count_sink(Count &count)
+{
+    return count_sink<Count>(count);
+}
+
+template <class Map>
+per_key_count_sink<Map> make_per_key_count_sink(Map &counts)
+{
+    return per_key_count_sink<Map>(counts);
+}
+
+template <class Sum>
+overlap_sum_sink<Sum> make_overlap_sum_sink(Sum &sum)
+{
+    return overlap_sum_sink<Sum>(sum);
+}
+
+#endif
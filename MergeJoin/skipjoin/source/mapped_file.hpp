@@ -0,0 +1,186 @@
+#ifndef INCLUDE_MAPPED_FILE_HPP
+#define INCLUDE_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+/**
+ * Read-only memory mapping of a complete file. The mapping is released when the
+ * mapped_file is destroyed. Throw an invalid_argument if the file cannot be
+ * opened or mapped.
+ */
+class mapped_file
+{
+public:
+    /**
+     * Map the file at the provided path.
+     */
+    explicit mapped_file(const std::string& path)
+    {
+        open(path);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    /**
+     * Move-construct and move-assign: take over the mapping of other.
+     */
+    mapped_file(mapped_file&& other) noexcept
+    {
+        swap(other);
+    }
+    mapped_file& operator=(mapped_file&& other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    /**
+     * Release the mapping.
+     */
+    ~mapped_file()
+    {
+        close();
+    }
+
+    /**
+     * Return the mapped bytes. An empty file has no mapping (data() returns a
+     * null pointer).
+     */
+    const char* data() const
+    {
+        return data_pointer;
+    }
+    const char* begin() const
+    {
+        return data_pointer;
+    }
+    const char* end() const
+    {
+        return data_pointer + data_size;
+    }
+
+    /**
+     * Return the size of the file in bytes.
+     */
+    std::size_t size() const
+    {
+        return data_size;
+    }
+
+    void swap(mapped_file& other) noexcept
+    {
+        std::swap(data_pointer, other.data_pointer);
+        std::swap(data_size, other.data_size);
+#if defined(_WIN32)
+        std::swap(file, other.file);
+        std::swap(mapping, other.mapping);
+#endif
+    }
+
+private:
+#if defined(_WIN32)
+    void open(const std::string& path)
+    {
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::invalid_argument("could not open " + path);
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size)) {
+            close();
+            throw std::invalid_argument("could not determine the size of " + path);
+        }
+        data_size = static_cast<std::size_t>(size.QuadPart);
+        if (data_size == 0) {
+            return;
+        }
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            data_pointer = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (data_pointer == nullptr) {
+            close();
+            throw std::invalid_argument("could not map " + path);
+        }
+    }
+
+    void close()
+    {
+        if (data_pointer != nullptr) {
+            UnmapViewOfFile(data_pointer);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        data_pointer = nullptr;
+        data_size = 0;
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+    }
+
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    void open(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::invalid_argument("could not open " + path);
+        }
+
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            ::close(fd);
+            throw std::invalid_argument("could not determine the size of " + path);
+        }
+        data_size = static_cast<std::size_t>(status.st_size);
+        if (data_size == 0) {
+            ::close(fd);
+            return;
+        }
+
+        /* The mapping remains valid after closing the file descriptor. */
+        void* pointer = mmap(nullptr, data_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (pointer == MAP_FAILED) {
+            data_size = 0;
+            throw std::invalid_argument("could not map " + path);
+        }
+        madvise(pointer, data_size, MADV_SEQUENTIAL);
+        data_pointer = static_cast<const char*>(pointer);
+    }
+
+    void close()
+    {
+        if (data_pointer != nullptr) {
+            munmap(const_cast<char*>(data_pointer), data_size);
+        }
+        data_pointer = nullptr;
+        data_size = 0;
+    }
+#endif
+
+    const char* data_pointer = nullptr;
+    std::size_t data_size = 0;
+};
+
+#endif
@@ -29,8 +29,10 @@
 #include <fstream>
 #include <iostream>
 #include <set>
+#include <thread>
 #include <vector>
 
+#include "binary_dataset.hpp"
 #include "dataset.hpp"
 #include "performance_measure.hpp"
 #include "stab_forest.hpp"
@@ -78,6 +80,20 @@ void append_measure(InIt begin, InIt end, Other... other)
               << '\t' << (end_mem - start_mem);
 }
 
+template<class Container, class InIt>
+void bulk_measure(InIt begin, InIt end, const std::size_t n_threads)
+{
+    using namespace std::chrono;
+
+    auto start_mem = memory_usage();
+    auto start_time = high_resolution_clock::now();
+    Container container(begin, end, n_threads);
+    auto end_time = high_resolution_clock::now();
+    auto end_mem = memory_usage();
+    std::cout << duration_cast<milliseconds>(end_time - start_time).count()
+              << '\t' << (end_mem - start_mem);
+}
+
 template<class InIt, class SizeType>
 void measure(InIt begin, const SizeType n)
 {
@@ -94,6 +110,10 @@ void measure(InIt begin, const SizeType n)
     append_measure<std::multiset<event, compare>>(begin, end, std::true_type());
     std::cout << '\t';
     append_measure<stab_forest<timestamp, vector_event_list>>(begin, end);
+    std::cout << '\t';
+    bulk_measure<stab_forest<timestamp, vector_event_list>>(begin, end, 1);
+    std::cout << '\t';
+    bulk_measure<stab_forest<timestamp, vector_event_list>>(begin, end, std::thread::hardware_concurrency());
     std::cout << std::endl;
 }
 
@@ -113,11 +133,7 @@ int main(int argc, char* argv[])
         try {
             increment = to_unsigned<std::size_t>(argv[2]);
             runs = to_unsigned<std::size_t>(argv[3]);
-            std::ifstream data_file(argv[1]);
-            if (!data_file) {
-                throw std::invalid_argument("could not read data file");
-            }
-            data = read_events<std::uint32_t>(data_file);
+            data = load_events<std::uint32_t>(argv[1]);
         }
         catch (std::exception& ex) {
             std::cout << "error: " << ex.what() << std::endl;
@@ -127,7 +143,7 @@ int main(int argc, char* argv[])
         std::sort(data.begin(), data.end(), event::start_end_compare());
         auto begin = data.cbegin();
         auto size = data.size();
-        std::cout << "size\tvector\tvectormem\tmultiset\tmultisetmem\tmultiset*\tmultiset*mem\tstab-forest\tstab-forestmem\n";
+        std::cout << "size\tvector\tvectormem\tmultiset\tmultisetmem\tmultiset*\tmultiset*mem\tstab-forest\tstab-forestmem\tbulk\tbulkmem\tbulk*\tbulk*mem\n";
         for (std::size_t i = 0; i < runs; ++i) {
             std::cout << "run: " << i << "\n";
             for (auto n = increment; n < size; n += increment) {
@@ -76,16 +76,16 @@ measure_parallel_skip_join(const size_t n_threads, const size_t f, const StabFor
 {
     using namespace std::chrono;
     using event = typename StabForest::event;
-    using OutputIterator = std::back_insert_iterator<std::vector<std::pair<event, event>>>;
 
-    ParallelOutputHelper<OutputIterator, event> outputs;
+    ParallelOutputCollector<event> outputs(n_threads);
 
     auto start = high_resolution_clock::now();
-    parallel_join(n_threads, f, lhs, rhs, outputs, policy_l, policy_r);
+    WorkStealingPoolHandler pool(n_threads);
+    parallel_join(pool, f, lhs, rhs, outputs, policy_l, policy_r);
     auto end = high_resolution_clock::now();
 
-    std::vector<std::pair<event, event>> output;
-    outputs.merge_output(output);
+    typename ParallelOutputCollector<event>::Result output;
+    outputs.merge_output(output, pool);
     std::sort(output.begin(), output.end(), [](auto const& l, auto const& r) {return l.first.start < r.first.start; });
     std::cerr << '\t' << output.size();
     return duration_cast<milliseconds>(end - start).count();
@@ -31,7 +31,7 @@
 #include "dataset.hpp"
 #include "stab_forest.hpp"
 #include "measure_join.hpp"
-#include "parallelskipjoin.h"
+#include "../../parallelskipjoin.h"
 
 void run_gap_size(std::uint32_t gap_size)
 {
@@ -64,6 +64,7 @@ void run_gap_size(std::uint32_t gap_size)
               << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_list(), stab_forward_list())
               << "\t" << measure_parallel_skip_join(n_threads, f, lhs, rhs, stab_forward_list(), stab_forward_list())
               // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_index(), stab_forward_index())
+              // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_prefetch(), stab_forward_prefetch())
               // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_check(lhs, 1u), stab_forward_check(rhs, 1u))
               // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_check(lhs, 2u), stab_forward_check(rhs, 2u))
               // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_check(lhs, 4u), stab_forward_check(rhs, 4u))
@@ -71,6 +72,8 @@ void run_gap_size(std::uint32_t gap_size)
               // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_check(lhs, 16u), stab_forward_check(rhs, 16u))
               // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_check(lhs, 32u), stab_forward_check(rhs, 32u))
               // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_check(lhs, 64u), stab_forward_check(rhs, 64u))
+              // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_adaptive(lhs), stab_forward_adaptive(rhs))
+              // << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_gallop(lhs), stab_forward_gallop(rhs))
               << std::endl;
     std::cerr << std::endl;
 }
@@ -97,7 +100,7 @@ int main_skip_join(int argc, char* argv[])
             return 2;
         }
         
-        std::cout << "gap-size\tforward-scan\tskip-join-list\tskip-join-index\tskip-join-1c\tskip-join-2c\tskip-join-4c\tskip-join-8c\tskip-join-16c\tskip-join-32c\tskip-join-64c\n";
+        std::cout << "gap-size\tforward-scan\tskip-join-list\tskip-join-index\tskip-join-prefetch\tskip-join-1c\tskip-join-2c\tskip-join-4c\tskip-join-8c\tskip-join-16c\tskip-join-32c\tskip-join-64c\tskip-join-adaptive\tskip-join-gallop\n";
 
         for (std::size_t i = 0; i < runs; ++i) {
             std::cout << "run: " << i << std::endl;
@@ -105,4 +108,12 @@ int main_skip_join(int argc, char* argv[])
         }
         return 0;
     }
-}
\ No newline at end of file
+}
+
+/* MergeJoin.cpp includes this file and provides its own main. */
+#ifndef MEASURE_JUMP_NO_MAIN
+int main(int argc, char* argv[])
+{
+    return main_skip_join(argc, argv);
+}
+#endif
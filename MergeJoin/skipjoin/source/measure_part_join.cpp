@@ -30,6 +30,7 @@
 #include <iostream>
 #include <vector>
 
+#include "binary_dataset.hpp"
 #include "dataset.hpp"
 #include "stab_forest.hpp"
 #include "measure_join.hpp"
@@ -50,6 +51,7 @@ void run(const StabForest& lhs, const EventList& events)
                   << "\t" << measure_forward_scan(lhs, rhs)
                   << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_list(), stab_forward_list())
                   << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_check(lhs, 16u), stab_forward_check(rhs, 16u))
+                  << "\t" << measure_forward_skip_join(lhs, rhs, stab_forward_adaptive(lhs), stab_forward_adaptive(rhs))
                   << std::endl;
         std::cerr << std::endl;
     }
@@ -69,16 +71,8 @@ int main(int argc, char* argv[])
         std::size_t runs;
         try {
             runs = to_unsigned<std::size_t>(argv[3]);
-            std::ifstream first_data_file(argv[1]);
-            std::ifstream second_data_file(argv[2]);
-            if (!first_data_file) {
-                throw std::invalid_argument("could not read first data file");
-            }
-            if (!second_data_file) {
-                throw std::invalid_argument("could not read second data file");
-            }
-            first_data = read_events<timestamp>(first_data_file);
-            second_data = read_events<timestamp>(second_data_file);
+            first_data = load_events<timestamp>(argv[1]);
+            second_data = load_events<timestamp>(argv[2]);
         }
         catch (std::exception& ex) {
             std::cout << "error: " << ex.what() << std::endl;
@@ -90,7 +84,7 @@ int main(int argc, char* argv[])
             lhs_sf.append_event(event);
         }
 
-        std::cout << "size\tforward-scan\tskip-join-list\tskip-join-16c\n";
+        std::cout << "size\tforward-scan\tskip-join-list\tskip-join-16c\tskip-join-adaptive\n";
         for (std::size_t i = 0; i < runs; ++i) {
             std::cout << "run: " << i << std::endl;
             run(lhs_sf, second_data);
@@ -29,6 +29,7 @@
 #include <iostream>
 #include <vector>
 
+#include "binary_dataset.hpp"
 #include "dataset.hpp"
 #include "stab_forest.hpp"
 #include "measure_join.hpp"
@@ -47,6 +48,7 @@ void run(const StabForest& flights, const PeriodList& periods)
                   << "\t" << measure_forward_scan(flights, periods_sf)
                   << "\t" << measure_forward_skip_join(flights, periods_sf, stab_forward_list(), stab_forward_list())
                   << "\t" << measure_forward_skip_join(flights, periods_sf, stab_forward_check(flights, 16u), stab_forward_check(periods_sf, 16u))
+                  << "\t" << measure_forward_skip_join(flights, periods_sf, stab_forward_adaptive(flights), stab_forward_adaptive(periods_sf))
                   << "\t" << measure_multi_window(flights, periods.cbegin(), periods.cbegin() + i, stab_forward_check(flights, 16u))
                   << std::endl;
         std::cerr << std::endl;
@@ -67,16 +69,8 @@ int main(int argc, char* argv[])
         std::size_t runs;
         try {
             runs = to_unsigned<std::size_t>(argv[3]);
-            std::ifstream flight_data_file(argv[1]);
-            std::ifstream period_data_file(argv[2]);
-            if (!flight_data_file) {
-                throw std::invalid_argument("could not read flight data file");
-            }
-            if (!period_data_file) {
-                throw std::invalid_argument("could not read period data file");
-            }
-            flights = read_events<timestamp>(flight_data_file);
-            periods = read_events<timestamp>(period_data_file);
+            flights = load_events<timestamp>(argv[1]);
+            periods = load_events<timestamp>(argv[2]);
         }
         catch (std::exception& ex) {
             std::cout << "error: " << ex.what() << std::endl;
@@ -88,7 +82,7 @@ int main(int argc, char* argv[])
             flight_sf.append_event(event);
         }
 
-        std::cout << "numperiods\tforward_scan\tskip-join-list\tskip-join-16c\tmulti-window\n";
+        std::cout << "numperiods\tforward_scan\tskip-join-list\tskip-join-16c\tskip-join-adaptive\tmulti-window\n";
         for (std::size_t i = 0; i < runs; ++i) {
             std::cout << "run: " << i << std::endl;
             run(flight_sf, periods);
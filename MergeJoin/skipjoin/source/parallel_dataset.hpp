@@ -0,0 +1,234 @@
+#ifndef INCLUDE_PARALLEL_DATASET_HPP
+#define INCLUDE_PARALLEL_DATASET_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "interval.hpp"
+#include "mapped_file.hpp"
+
+namespace parallel_dataset_detail
+{
+    /**
+     * Return true if c is a whitespace character (as used by operator>>).
+     */
+    inline bool is_space(const char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    /**
+     * Return a word in which exactly the bytes that do not hold a decimal digit
+     * in the provided (little-endian) word of eight characters are non-zero.
+     * Carries out of a byte only happen for bytes that are no digits, hence the
+     * first non-zero byte is always exact.
+     */
+    inline std::uint64_t non_digit_mask(const std::uint64_t word)
+    {
+        constexpr std::uint64_t high = 0xF0F0F0F0F0F0F0F0ull;
+        constexpr std::uint64_t zeros = 0x3030303030303030ull;
+        constexpr std::uint64_t sixes = 0x0606060606060606ull;
+        return ((word & high) ^ zeros) | (((word + sixes) & high) ^ zeros);
+    }
+
+    /**
+     * Return the value of the first length (1 <= length <= 8) decimal digits of
+     * the provided (little-endian) word of eight characters.
+     */
+    inline std::uint64_t parse_eight_digits(std::uint64_t word, const unsigned length)
+    {
+        /* Move the digits to the top bytes; the zero bytes shifted in act as
+         * leading zeros. */
+        word <<= 8 * (8 - length);
+        word = ((word & 0x0F0F0F0F0F0F0F0Full) * 2561) >> 8;
+        word = ((word & 0x00FF00FF00FF00FFull) * 6553601) >> 16;
+        return ((word & 0x0000FFFF0000FFFFull) * 42949672960001ull) >> 32;
+    }
+
+    /**
+     * The tokens parsed from a chunk of the input. Tokens that are not valid
+     * values are stored as zero; the first such token is recorded.
+     */
+    template<class UInt>
+    struct chunk_tokens
+    {
+        std::vector<UInt> values;
+        std::size_t error_index = std::numeric_limits<std::size_t>::max();
+        const char* error = nullptr;
+    };
+
+    /**
+     * Parse all whitespace-separated tokens in [first, last) as values of type
+     * UInt with the same checks as to_unsigned. The range [first, eof) must be
+     * readable; words are read up-to eof.
+     */
+    template<class UInt>
+    void parse_chunk(const char* first, const char* last, const char* eof, chunk_tokens<UInt>& result)
+    {
+        constexpr std::uint64_t max_value = std::numeric_limits<UInt>::max();
+        constexpr std::uint64_t powers[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+        result.values.reserve((last - first) / 8);
+        while (first != last) {
+            if (is_space(*first)) {
+                ++first;
+                continue;
+            }
+
+            const char* error = nullptr;
+            std::uint64_t value = 0;
+            while (first != last && !is_space(*first)) {
+                /* Determine the next piece of at most eight digits. */
+                unsigned length = 0;
+                std::uint64_t piece = 0;
+                if constexpr (std::endian::native == std::endian::little) {
+                    if (eof - first >= 8) {
+                        std::uint64_t word;
+                        std::memcpy(&word, first, sizeof(word));
+                        auto mask = non_digit_mask(word);
+                        length = (mask == 0) ? 8 : std::countr_zero(mask) / 8;
+                        length = std::min<unsigned>(length, static_cast<unsigned>(last - first));
+                        if (length != 0) {
+                            piece = parse_eight_digits(word, length);
+                        }
+                    }
+                    else {
+                        for (; length < 8 && first + length != last && '0' <= first[length] && first[length] <= '9'; ++length) {
+                            piece = piece * 10 + (first[length] - '0');
+                        }
+                    }
+                }
+                else {
+                    for (; length < 8 && first + length != last && '0' <= first[length] && first[length] <= '9'; ++length) {
+                        piece = piece * 10 + (first[length] - '0');
+                    }
+                }
+
+                /* A character that is neither a digit nor whitespace. */
+                if (length == 0) {
+                    error = "input not a positive integer";
+                    while (first != last && !is_space(*first)) {
+                        ++first;
+                    }
+                    break;
+                }
+
+                first += length;
+                if (error == nullptr) {
+                    if (piece > max_value || (max_value - piece) / powers[length] < value) {
+                        error = "input integer is too big";
+                    }
+                    else {
+                        value = value * powers[length] + piece;
+                    }
+                }
+            }
+
+            if (error != nullptr && result.error == nullptr) {
+                result.error = error;
+                result.error_index = result.values.size();
+            }
+            result.values.push_back(error == nullptr ? static_cast<UInt>(value) : UInt(0));
+        }
+    }
+
+    /**
+     * Call f(i) for every i in [0, n) using n_threads threads that claim the
+     * indices in increasing order.
+     */
+    template<class Function>
+    void parallel_for_each_index(const std::size_t n, const std::size_t n_threads, Function f)
+    {
+        std::atomic<std::size_t> next(0);
+        auto worker = [&]() {
+            for (auto i = next++; i < n; i = next++) {
+                f(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (std::size_t t = 1; t < std::min(n, n_threads); ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+}
+
+/**
+ * Read the text file at the provided path into a list of intervals, exactly as
+ * read_events would: each consecutive pair of whitespace-separated values is
+ * interpreted as a (start, end)-pair. The file is memory-mapped and split into
+ * newline-aligned chunks that are parsed by n_threads threads (all hardware
+ * threads if zero). Throw an invalid_argument if the file cannot be read or if
+ * a value is not a positive integer or is to big.
+ */
+template<class UInt>
+std::vector<interval<UInt>> read_events_parallel(const std::string& path, std::size_t n_threads = 0)
+{
+    using namespace parallel_dataset_detail;
+    constexpr std::size_t min_chunk_size = 1 << 16;
+
+    if (n_threads == 0) {
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    mapped_file file(path);
+    const char* first = file.begin();
+    const char* last = file.end();
+
+    /* Split the file into chunks that end directly after a newline. */
+    std::size_t n_chunks = std::max<std::size_t>(1, std::min(4 * n_threads, file.size() / min_chunk_size));
+    std::vector<const char*> bounds{first};
+    for (std::size_t i = 1; i < n_chunks; ++i) {
+        const char* bound = std::max(first + file.size() / n_chunks * i, bounds.back());
+        bound = std::find(bound, last, '\n');
+        bounds.push_back(bound == last ? last : bound + 1);
+    }
+    bounds.push_back(last);
+
+    /* Parse the chunks. */
+    std::vector<chunk_tokens<UInt>> chunks(n_chunks);
+    parallel_for_each_index(n_chunks, n_threads, [&](const std::size_t i) {
+        parse_chunk(bounds[i], bounds[i + 1], last, chunks[i]);
+    });
+
+    /* Determine the position of the tokens of each chunk in the output. As in
+     * read_events, a trailing unpaired token is ignored (even if invalid). */
+    std::vector<std::size_t> offsets(n_chunks + 1, 0);
+    for (std::size_t i = 0; i < n_chunks; ++i) {
+        offsets[i + 1] = offsets[i] + chunks[i].values.size();
+    }
+    std::size_t pairs = offsets[n_chunks] / 2;
+    for (std::size_t i = 0; i < n_chunks; ++i) {
+        if (chunks[i].error != nullptr && offsets[i] + chunks[i].error_index < 2 * pairs) {
+            throw std::invalid_argument(chunks[i].error);
+        }
+    }
+
+    /* Pair the tokens. */
+    std::vector<interval<UInt>> data(pairs);
+    parallel_for_each_index(n_chunks, n_threads, [&](const std::size_t i) {
+        auto position = offsets[i];
+        for (auto value : chunks[i].values) {
+            if (position < 2 * pairs) {
+                auto& event = data[position / 2];
+                ((position % 2 == 0) ? event.start : event.end) = value;
+            }
+            ++position;
+        }
+        std::vector<UInt>().swap(chunks[i].values);
+    });
+    return data;
+}
+
+#endif
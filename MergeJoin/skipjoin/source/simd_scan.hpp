@@ -0,0 +1,126 @@
+#ifndef INCLUDE_SIMD_SCAN_HPP
+#define INCLUDE_SIMD_SCAN_HPP
+
+#include <bit>
+#include <cstdint>
+#include "interval.hpp"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Return a pointer to the first event in [first, last) that starts after value.
+ * The events in [first, last) must be sorted on start-time, hence all events
+ * before the returned pointer start at-or-before value.
+ */
+template <class Event>
+const Event *find_start_after(const Event *first, const Event *last, const typename Event::unsigned_type value)
+{
+    while (first != last && first->start <= value)
+    {
+        ++first;
+    }
+    return first;
+}
+
+/**
+ * Vectorized version for 32-bit timestamps: compares the start-times of eight
+ * events at once. As the events are sorted, the events that start at-or-before
+ * value form a prefix of the range; the first set bit in the comparison mask
+ * marks its end. Start-times are the even 32-bit lanes of the loaded events.
+ */
+inline const interval<std::uint32_t> *find_start_after(const interval<std::uint32_t> *first,
+                                                       const interval<std::uint32_t> *last,
+                                                       const std::uint32_t value)
+{
+#if defined(__AVX512F__)
+    const __m512i v = _mm512_set1_epi32((int)value);
+    while (last - first >= 8)
+    {
+        __m512i events = _mm512_loadu_si512((const void *)first);
+        unsigned mask = _mm512_cmpgt_epu32_mask(events, v) & 0x5555u;
+        if (mask != 0)
+        {
+            return first + std::countr_zero(mask) / 2;
+        }
+        first += 8;
+    }
+#elif defined(__AVX2__)
+    /* AVX2 only has signed comparisons: flip the sign bits of both sides. */
+    const __m256i sign = _mm256_set1_epi32((int)0x80000000u);
+    const __m256i v = _mm256_xor_si256(_mm256_set1_epi32((int)value), sign);
+    while (last - first >= 8)
+    {
+        __m256i lo = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)first), sign);
+        __m256i hi = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(first + 4)), sign);
+        unsigned mask_lo = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(lo, v)));
+        unsigned mask_hi = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(hi, v)));
+        unsigned mask = (mask_lo | (mask_hi << 8)) & 0x5555u;
+        if (mask != 0)
+        {
+            return first + std::countr_zero(mask) / 2;
+        }
+        first += 8;
+    }
+#endif
+    while (first != last && first->start <= value)
+    {
+        ++first;
+    }
+    return first;
+}
+
+/**
+ * Return a pointer to the first start-time in the ascending start-time column
+ * [first, last) that is larger than value.
+ */
+template <class TimeStampType>
+const TimeStampType *find_value_after(const TimeStampType *first, const TimeStampType *last, const TimeStampType value)
+{
+    while (first != last && *first <= value)
+    {
+        ++first;
+    }
+    return first;
+}
+
+/**
+ * Vectorized version for 32-bit start-time columns (soa_event_list). Every
+ * loaded lane is a start-time: sixteen (AVX-512) or eight (AVX2) per compare.
+ */
+inline const std::uint32_t *find_value_after(const std::uint32_t *first, const std::uint32_t *last, const std::uint32_t value)
+{
+#if defined(__AVX512F__)
+    const __m512i v = _mm512_set1_epi32((int)value);
+    while (last - first >= 16)
+    {
+        unsigned mask = _mm512_cmpgt_epu32_mask(_mm512_loadu_si512((const void *)first), v);
+        if (mask != 0)
+        {
+            return first + std::countr_zero(mask);
+        }
+        first += 16;
+    }
+#elif defined(__AVX2__)
+    const __m256i sign = _mm256_set1_epi32((int)0x80000000u);
+    const __m256i v = _mm256_xor_si256(_mm256_set1_epi32((int)value), sign);
+    while (last - first >= 8)
+    {
+        __m256i starts = _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)first), sign);
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(starts, v)));
+        if (mask != 0)
+        {
+            return first + std::countr_zero(mask);
+        }
+        first += 8;
+    }
+#endif
+    while (first != last && *first <= value)
+    {
+        ++first;
+    }
+    return first;
+}
+
+#endif
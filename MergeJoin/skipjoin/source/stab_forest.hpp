@@ -28,10 +28,21 @@
 #define INCLUDE_STAB_FOREST_HPP
 
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include "algorithm.hpp"
 #include "block_list.hpp"
 #include "interval.hpp"
+#include "interval_columns.hpp"
 #include "raw_array.hpp"
 
 /**
@@ -42,6 +53,15 @@ struct stab_forward_index
 {
 };
 
+/**
+ * Stab-forward policy enabling that every stab-forward operation is performed
+ * exclusively using the index, whereby the navigation through the index
+ * prefetches the next node and left-list before processing the current node.
+ */
+struct stab_forward_prefetch
+{
+};
+
 /**
  * Stab-forward policy enabling that every stab-forward operation is performed
  * exclusively using the event-list.
@@ -65,6 +85,156 @@ struct stab_forward_check
     const std::size_t threshold;
 };
 
+/**
+ * Stab-forward policy enabling that every stab-forward operation first finds
+ * the first event that starts after the provided timestamp by an exponential
+ * (galloping) search over the event-list. If this skips at most a threshold
+ * number of events (as in stab_forward_check), then the skipped events are only
+ * checked on their end-time; otherwise, only the active events among them are
+ * recovered, by a stab on the left-lists and max-lists of the index that is
+ * restricted to the events that start at-or-after the first skipped event (the
+ * index is not used to find the position after the skip). The galloping search
+ * requires an event-list with random-access iterators (vector_event_list or
+ * soa_event_list); on other event-lists, every stab-forward operation is
+ * performed using the event-list.
+ */
+struct stab_forward_gallop
+{
+    /* Only stab-forests: a moved stab-forward helper, which derives from its
+     * policy, must copy the policy instead. */
+    template <class StabForest>
+        requires requires(const StabForest &forest) { forest.index_height(); }
+    explicit stab_forward_gallop(const StabForest &forest, const std::size_t c = 16) : threshold(c * std::max<std::size_t>(1u, forest.index_height())) {}
+
+    std::size_t threshold;
+};
+
+/**
+ * Stab-forward policy enabling that every stab-forward operation is performed
+ * using the event-list and, if the event-list scan does not reach the provided
+ * timestamp within a threshold number of events, then using the index. The
+ * threshold is tuned at runtime, within the range of threshold factors 1 to 64
+ * (see stab_forward_check): the policy samples the cost of event-list scans
+ * (per event) and of index jumps and sets the threshold to the skip distance at
+ * which both are equally expensive. Hence, every stab-forward operation costs
+ * at most twice as much as the cheapest of both. If the recent index jumps
+ * skipped much more than the threshold, then the index is used directly.
+ */
+struct stab_forward_adaptive
+{
+    using clock = std::chrono::steady_clock;
+
+    /* The initial, minimum, and maximum threshold factor (see
+     * stab_forward_check). */
+    static constexpr std::size_t initial_factor = 16;
+    static constexpr std::size_t min_factor = 1;
+    static constexpr std::size_t max_factor = 64;
+
+    /* One out of every list_sample_period event-list scans and out of every
+     * index_sample_period index jumps is timed. Scans over less than
+     * min_sample_events events are dominated by the cost of reading the clock
+     * and are not used. */
+    static constexpr std::size_t list_sample_period = 256;
+    static constexpr std::size_t index_sample_period = 16;
+    static constexpr std::size_t min_sample_events = 32;
+
+    /* The weight of a new sample in the moving averages. */
+    static constexpr double smoothing = 0.125;
+
+    /* The event-list scan is omitted if the average skip distance of index
+     * jumps exceeds direct_factor times the threshold. */
+    static constexpr std::size_t direct_factor = 8;
+
+    /* Only stab-forests, see stab_forward_gallop. */
+    template <class StabForest>
+        requires requires(const StabForest &forest) { forest.index_height(); }
+    explicit stab_forward_adaptive(const StabForest &forest) : threshold(initial_factor * std::max<std::size_t>(1u, forest.index_height())),
+                                                               min_threshold(min_factor * std::max<std::size_t>(1u, forest.index_height())),
+                                                               max_threshold(max_factor * std::max<std::size_t>(1u, forest.index_height())),
+                                                               clock_overhead(measure_clock_overhead()) {}
+
+    /**
+     * Add a sample of the cost (in nanoseconds, including the clock overhead)
+     * of an event-list scan over the specified number of events, or of an
+     * index jump.
+     */
+    void add_list_sample(const double cost, const std::size_t events)
+    {
+        if (events >= min_sample_events)
+        {
+            list_cost = average(list_cost, std::max(0.0, cost - clock_overhead) / events);
+            update_threshold();
+        }
+    }
+    void add_index_sample(const double cost)
+    {
+        index_cost = average(index_cost, std::max(0.0, cost - clock_overhead));
+        update_threshold();
+    }
+
+    /**
+     * Add the number of events skipped by an index jump.
+     */
+    void add_index_skip(const std::size_t events)
+    {
+        index_skip = average(index_skip, static_cast<double>(events));
+    }
+
+    /**
+     * Return true if the event-list scan can be omitted.
+     */
+    bool direct_index() const
+    {
+        return index_skip > static_cast<double>(direct_factor * threshold);
+    }
+
+    /* The current threshold and its range. */
+    std::size_t threshold;
+    std::size_t min_threshold;
+    std::size_t max_threshold;
+
+    /* The number of event-list scans and index jumps performed. */
+    std::size_t list_calls = 0;
+    std::size_t index_calls = 0;
+
+private:
+    static double average(const double current, const double sample)
+    {
+        return (current == 0.0) ? sample : current + smoothing * (sample - current);
+    }
+
+    void update_threshold()
+    {
+        if (list_cost > 0.0 && index_cost > 0.0)
+        {
+            auto ratio = index_cost / list_cost;
+            threshold = (ratio >= static_cast<double>(max_threshold)) ? max_threshold
+                                                                       : std::max(min_threshold, static_cast<std::size_t>(ratio));
+        }
+    }
+
+    static double measure_clock_overhead()
+    {
+        auto overhead = std::chrono::duration<double, std::nano>::max();
+        for (int i = 0; i < 16; ++i)
+        {
+            auto start = clock::now();
+            overhead = std::min(overhead, std::chrono::duration<double, std::nano>(clock::now() - start));
+        }
+        return overhead.count();
+    }
+
+    /* The moving averages of the cost of scanning an event, of the cost of an
+     * index jump, and of the number of events skipped by an index jump (zero
+     * if not yet measured). */
+    double list_cost = 0.0;
+    double index_cost = 0.0;
+    double index_skip = 0.0;
+
+    /* The cost of reading the clock. */
+    double clock_overhead;
+};
+
 /**
  * Basic operations on event lists.
  */
@@ -171,10 +341,52 @@ protected:
     }
 };
 
+/**
+ * Use two std::vectors, one holding the start-times and one holding the
+ * end-times, to represent the event-list. Scans that only look at start-times
+ * (the sweeps in the joins and the event-list stab-forward) read half the data
+ * of a vector_event_list. As with vector_event_list, we use indices as stable
+ * pointers.
+ */
+template <class TimeStampType>
+class soa_event_list : public basic_event_list<interval_columns<TimeStampType>>
+{
+protected:
+    using bel = basic_event_list<interval_columns<TimeStampType>>;
+    using event_list_type = typename bel::event_list_type;
+    using const_iterator = typename bel::const_iterator;
+    using stable_event_pointer = typename event_list_type::size_type;
+
+    /**
+     * Default-constructor.
+     */
+    soa_event_list() : bel() {}
+
+    /**
+     * Return a stable pointer pointing to the same element as the provided
+     * iterator.
+     */
+    stable_event_pointer stabilize_iterator(const const_iterator it) const
+    {
+        return std::distance(this->cbegin(), it);
+    }
+
+    /**
+     * Return an iterator pointing to the same element as the provided
+     * stable pointer.
+     */
+    const_iterator unstabilize_pointer(const stable_event_pointer p) const
+    {
+        return std::next(this->cbegin(), p);
+    }
+};
+
 /**
  * Use a block-list to represent the event-list. Compared to a std::vector, this
  * yields faster appends and slower traversals. The current implementation does
- * not provide the stab-forward jump-optimization.
+ * not provide the stab-forward jump-optimization. As the block-list can remove
+ * events from its front, this is the event-list that supports eviction (see
+ * stab_forest::evict_before).
  */
 template <class TimeStampType>
 class block_event_list : public basic_event_list<block_list<interval<TimeStampType>>>
@@ -209,108 +421,506 @@ protected:
     }
 };
 
+/* Forward declarations of the stab-forward helper, of the stab_search
+ * navigation operations, of the read-only memory-mapped stab-forest, and of the
+ * read-only snapshots published by the concurrent stab-forest. */
+template <class StabForest, class OutputIterator, class JumpPolicy>
+class basic_stab_forward_helper;
+template <class StabForest, class OutputIterator>
+struct basic_stab_operations;
+template <class StabForest, class OutputIterator>
+struct basic_stab_batch_operations;
+template <class TimeStampType>
+class mapped_stab_forest;
+template <class TimeStampType>
+class stab_forest_snapshot;
+
 /**
- * The stab forest for the specified timestamp type and the specified underlying
- * implementation of the event-list (vector_event_list or block_event_list).
+ * Navigation and left-list primitives shared by the stab-forest and by
+ * read-only views on stab-forests (mapped_stab_forest). These only rely on the
+ * fields of stab-tree nodes (see stab_forest::stab_tree_node), and not on how
+ * these nodes are stored.
  */
-template <class TimeStampType, template <class> class EventList = vector_event_list>
-class stab_forest : public EventList<TimeStampType>
+template <class TimeStampType>
+class stab_navigation
 {
-public:
-    using event_list_base = EventList<TimeStampType>;
-    using stab_forest_type = stab_forest<TimeStampType, EventList>;
-
-    using timestamp = typename event_list_base::timestamp;
-    using event = typename event_list_base::event;
-    using const_iterator = typename event_list_base::const_iterator;
-    using stable_event_pointer = typename event_list_base::stable_event_pointer;
-    using size_type = typename event_list_base::size_type;
+protected:
+    using timestamp = TimeStampType;
 
-    /* Forward declaration of the stab-forward helper. */
-    template <class OutputIterator, class JumpPolicy>
-    class stab_forward_helper;
+    /* Return the begin() and end() iterators to the left-list (navigation key),
+     * sorted on ascending start-time order. */
+    template <class Node>
+    static auto nll_sa_begin(Node &node) { return node.ll_raw_data.data(); }
+    template <class Node>
+    static auto nll_sa_end(Node &node) { return node.ll_raw_data.data() + node.nll_size; }
 
-private:
-    using event_list_base::event_list;
-    using event_list_base::stabilize_iterator;
-    using event_list_base::unstabilize_pointer;
+    /* Return the begin() and end() iterators to the left-list (data key),
+     * sorted on descending end-time order. */
+    template <class Node>
+    static auto dll_ed_begin(Node &node) { return node.ll_raw_data.data() + node.nll_size; }
+    template <class Node>
+    static auto dll_ed_end(Node &node) { return node.ll_raw_data.data() + node.ll_size; }
 
-public:
-    /**
-     * Default-constructor.
-     */
-    stab_forest() : event_list_base(), nodes(), index(),
-                    tail_pointer(stabilize_iterator(event_list.cend())),
-                    min_key(std::numeric_limits<timestamp>::max()) {}
+    /* Return the begin() and end() iterators to the left-list (navigation key),
+     * sorted on descending end-time order. */
+    template <class Node>
+    static auto nll_ed_begin(Node &node) { return node.ll_raw_data.data() + node.ll_size; }
+    template <class Node>
+    static auto nll_ed_end(Node &node) { return node.ll_raw_data.data() + node.ll_size + node.nll_size; }
 
     /**
-     * Append an event to the stab forest. The new event must be at-or-after, in
-     * lexicographic (start, end)-time order, the last event appended.
+     * Copy events in [first, last) to output that start before the specified
+     * value v (and start at-or-after mstart) from an ascending start-time
+     * ordered list of events; return an iterator pointing to the first value
+     * not copied. Observe that these functions do not return output iterators,
+     * making these functions work differently form the std::copy-family.
      */
-    void append_event(const event current)
+    template <class InIt, class OutIt>
+    static InIt copy_start_asc(InIt first, InIt last, OutIt output, const timestamp v)
     {
-        if (!event_list.empty())
+        while (first != last && first->start <= v)
         {
-            if (current.start != event_list.back().start)
-            {
-                build_leaf_forest_point();
-            }
-            event_list.emplace_back(current);
+            *output++ = *first++;
         }
-        else
+        return first;
+    }
+    template <class InIt, class OutIt>
+    static InIt copy_start_asc(InIt first, InIt last, OutIt output, const timestamp v, const timestamp mstart)
+    {
+        while (first != last && first->start < mstart)
         {
-            min_key = current.start;
-            event_list.emplace_back(current);
+            ++first;
         }
+        return copy_start_asc(first, last, output, v);
     }
 
-    void append_event(const timestamp start, const timestamp end)
+    /**
+     * Copy events in [first, last) to output that end after the specified
+     * value v (and start at-or-after mstart) from an descending end-time
+     * ordered list of events; return an iterator pointing to the first value
+     * not copied. Observe that these functions do not return output iterators,
+     * making these functions work differently form the std::copy-family.
+     */
+    template <class InIt, class OutIt>
+    static InIt copy_end_dec(InIt first, InIt last, OutIt output, const timestamp v)
     {
-        append_event(event{start, end});
+        while (first != last && first->end >= v)
+        {
+            *output++ = *first++;
+        }
+        return first;
+    }
+    template <class InIt, class OutIt>
+    static InIt copy_end_dec(InIt first, InIt last, OutIt output, const timestamp v, const timestamp mstart)
+    {
+        while (first != last && first->end >= v)
+        {
+            if (mstart <= first->start)
+            {
+                *output++ = *first;
+            }
+            ++first;
+        }
+        return first;
     }
 
     /**
-     * Perform a stab and search: copy all events active at value to output and
-     * return an iterator pointing to the first event that starts strictly after
-     * value.
+     * Return NavigateOperations::prefetch_navigation, if present, and false
+     * otherwise.
      */
-    template <class OutputIterator>
-    const_iterator stab_search(const timestamp value, OutputIterator output) const
+    template <class NavigateOperations>
+    static constexpr bool prefetch_navigation()
     {
-        stab_operations<OutputIterator> operations{*this, output};
-        navigate_index(value, operations);
-        return operations.next_it;
+        if constexpr (requires { NavigateOperations::prefetch_navigation; })
+        {
+            return NavigateOperations::prefetch_navigation;
+        }
+        else
+        {
+            return false;
+        }
     }
 
     /**
-     * Return a stab-forward helper that allows for repeated stab and scan
-     * operations (on increasing start-times). Can be used to answer
-     * multi-stab-queries and multi-window-queries. The end-user can fine tune
-     * the stabbing behavior by setting the jump policy used (index jumps with
-     * a specified threshold factor or event-list jumps).
+     * Query and navigate a stab-forest using its index (the list of
+     * forest-points) and the start-time min_key of its first event. This will
+     * search for the node for which nkey <= value <= dkey holds. This method
+     * uses callbacks to perform the necessary actions on each visited
+     * forest-point and stab-tree node. The following methods should be
+     * provided:
+     *
+     *   op.before_trees(value, other...) is called when value is smaller or
+     *     equal to the smallest start-time present in the stab-forest.
+     *   op.after_trees(value, other...) is called when value is larger than the
+     *     largest start-time present in the stab-forest (but not necessary
+     *     larger than the start-times of events in the event-list tail).
+     *   op.left_child(node, value, other...) is called to indicate that the
+     *     search will navigate to the left child of the specified node.
+     *   op.right_child(node, value, other...) is analogous to left_child.
+     *   op.select_node(node, value, other...) is called when node is the node
+     *     for which nkey <= value <= dkey holds.
+     *
+     * The methods before_trees, after_trees, and select_node are only called
+     * when the search has finished. The other... parameters are simply passed
+     * on to the callback functions.
      */
-    template <class OutputIterator, class JumpPolicy>
-    stab_forward_helper<OutputIterator, JumpPolicy> stab_forward_search(OutputIterator output,
-                                                                        const JumpPolicy &policy) const
+    template <class Node, class Index, class NavigateOperations, class... Other>
+    static void navigate_index(const Index &index, const timestamp min_key, const timestamp value,
+                               NavigateOperations &op, Other &...other)
     {
-        return stab_forward_helper<OutputIterator, JumpPolicy>{*this, output, policy};
-    }
+        /* Value not in the tree or the left-most timestamp. */
+        if (value <= min_key)
+        {
+            op.before_trees(value, other...);
+        }
 
-    template <class OutputIterator, class JumpPolicy>
-    std::shared_ptr<stab_forward_helper<OutputIterator, JumpPolicy>> stab_forward_search_shared(OutputIterator output,
-        const JumpPolicy& policy) const
-    {
-        return std::shared_ptr<stab_forward_helper<OutputIterator, JumpPolicy>>(new stab_forward_helper<OutputIterator, JumpPolicy>(*this, output, policy));
+        /* Value is indexed by the forest. */
+        else if (!index.empty() && value <= index.back().dkey)
+        {
+            navigate_stab_tree_node<Node>(&index.front(), value, op, other...);
+        }
+
+        /* Value after the last start time in the last tree. */
+        else
+        {
+            op.after_trees(value, other...);
+        }
     }
 
     /**
-     * Return the hieght of the index.
+     * Query and navigate a stab-tree. This method assumes that node has a
+     * descendant for which nkey <= value <= dkey holds. See navigate_index
+     * on the details of the navigation operations (we only use op.left_child(),
+     * op.right_child(), and op.select_node()).
+     *
+     * If NavigateOperations::prefetch_navigation is true, then the child
+     * navigated to and the left-list of the current node are prefetched
+     * before the current node is processed, such that the cache misses on both
+     * overlap with each other and with the processing of the left-list.
+     */
+    template <class Node, class NavigateOperations, class... Other>
+    static void navigate_stab_tree_node(const Node *node, timestamp value,
+                                        NavigateOperations &op, Other &...other)
+    {
+        /* Traverse the forest until the node is found for which value is
+         * active at [nkey, dkey]. */
+        while (!(node->nkey <= value && value <= node->dkey))
+        {
+            if (value < node->nkey)
+            {
+                const Node *next = node->left_ptr;
+                if constexpr (prefetch_navigation<NavigateOperations>())
+                {
+                    prefetch_read(next);
+                    prefetch_read(nll_sa_begin(*node));
+                }
+                op.left_child(*node, value, other...);
+                node = next;
+            }
+            else
+            {
+                const Node *next = node->right_ptr;
+                if constexpr (prefetch_navigation<NavigateOperations>())
+                {
+                    prefetch_read(next);
+                    prefetch_read(dll_ed_begin(*node));
+                }
+                op.right_child(*node, value, other...);
+                node = next;
+            }
+        }
+
+        /* The node is found. */
+        op.select_node(*node, value, other...);
+    }
+};
+
+/**
+ * The stab forest for the specified timestamp type and the specified underlying
+ * implementation of the event-list (vector_event_list, soa_event_list, or
+ * block_event_list).
+ */
+template <class TimeStampType, template <class> class EventList = vector_event_list>
+class stab_forest : public EventList<TimeStampType>, private stab_navigation<TimeStampType>
+{
+public:
+    using event_list_base = EventList<TimeStampType>;
+    using stab_forest_type = stab_forest<TimeStampType, EventList>;
+
+    using timestamp = typename event_list_base::timestamp;
+    using event = typename event_list_base::event;
+    using const_iterator = typename event_list_base::const_iterator;
+    using stable_event_pointer = typename event_list_base::stable_event_pointer;
+    using size_type = typename event_list_base::size_type;
+
+    /* The stab-forward helper. */
+    template <class OutputIterator, class JumpPolicy>
+    using stab_forward_helper = basic_stab_forward_helper<stab_forest_type, OutputIterator, JumpPolicy>;
+
+private:
+    using navigation = stab_navigation<TimeStampType>;
+
+    using event_list_base::event_list;
+
+    using navigation::nll_sa_begin;
+    using navigation::nll_sa_end;
+    using navigation::dll_ed_begin;
+    using navigation::dll_ed_end;
+    using navigation::nll_ed_begin;
+    using navigation::nll_ed_end;
+    using navigation::copy_start_asc;
+    using navigation::copy_end_dec;
+    using navigation::navigate_stab_tree_node;
+
+    template <class StabForest, class OutputIterator, class JumpPolicy>
+    friend class basic_stab_forward_helper;
+    template <class StabForest, class OutputIterator>
+    friend struct basic_stab_operations;
+    template <class StabForest, class OutputIterator>
+    friend struct basic_stab_batch_operations;
+    friend class mapped_stab_forest<TimeStampType>;
+    friend class stab_forest_snapshot<TimeStampType>;
+
+public:
+    /**
+     * Convert between iterators and stable pointers, which remain valid when
+     * events are appended (see the event-lists).
+     */
+    using event_list_base::stabilize_iterator;
+    using event_list_base::unstabilize_pointer;
+
+    /**
+     * Default-constructor.
+     */
+    stab_forest() : event_list_base(), nodes(), index(),
+                    tail_pointer(stabilize_iterator(event_list.cend())),
+                    min_key(std::numeric_limits<timestamp>::max()) {}
+
+    /**
+     * Bulk-load constructor: construct the stab forest holding the events in
+     * [first, last), which must be sorted in lexicographic (start, end)-time
+     * order. The resulting stab forest is identical to the one obtained by
+     * appending the events one-by-one, but the index is built in one pass over
+     * the events: all leaves are constructed up-front after which the
+     * stab-trees are built bottom-up. Independent subtrees are built
+     * concurrently by num_threads threads.
+     */
+    template <class InputIt>
+    stab_forest(InputIt first, InputIt last, const size_type num_threads = 1) : stab_forest()
+    {
+        bulk_load(first, last, num_threads);
+    }
+
+    /**
+     * Append an event to the stab forest. The new event must be at-or-after, in
+     * lexicographic (start, end)-time order, the last event appended.
+     */
+    void append_event(const event current)
+    {
+        if (!event_list.empty())
+        {
+            if (current.start != event_list.back().start)
+            {
+                build_leaf_forest_point();
+            }
+            event_list.emplace_back(current);
+        }
+        else
+        {
+            min_key = current.start;
+            event_list.emplace_back(current);
+        }
+    }
+
+    void append_event(const timestamp start, const timestamp end)
+    {
+        append_event(event{start, end});
+    }
+
+    /**
+     * Evict the stab-trees in the index, oldest first, of which all events end
+     * before the watermark, together with their events; return the number of
+     * events evicted. As the stab-tree nodes, the forest-points, and the events
+     * are stored in start-time order, an evicted stab-tree is a prefix of each;
+     * the block-lists release their blocks (and the left-lists of the evicted
+     * nodes are released) as soon as all values in a block are evicted. As the
+     * index never holds two stab-trees of equal height, stab-trees do not grow
+     * (much) beyond the number of events active in a window: evicting after
+     * every advance of the watermark keeps the memory use proportional to the
+     * window.
+     *
+     * Stabs at values at-or-after the watermark have the same results as
+     * before the eviction, stabs before the watermark miss the evicted events.
+     * Only supported by event-lists that can remove events from their front
+     * (block_event_list).
+     */
+    size_type evict_before(const timestamp watermark)
+        requires requires(typename event_list_base::event_list_type &list) { list.pop_front(); }
+    {
+        thaw();
+        size_type evicted = 0;
+        while (!index.empty() && ended_before(index.front(), watermark))
+        {
+            size_type tree_nodes = size_type(1) << index.front().height;
+            timestamp dkey = index.front().dkey;
+            for (size_type i = 0; i < tree_nodes; ++i)
+            {
+                nodes.pop_front();
+            }
+            while (event_list.front().start <= dkey)
+            {
+                event_list.pop_front();
+                ++evicted;
+            }
+            index.pop_front();
+        }
+
+        /* The event that caused the last leaf to be added is never evicted. */
+        if (evicted != 0)
+        {
+            min_key = event_list.front().start;
+        }
+        return evicted;
+    }
+
+    /**
+     * Perform a stab and search: copy all events active at value to output and
+     * return an iterator pointing to the first event that starts strictly after
+     * value.
+     */
+    template <class OutputIterator>
+    const_iterator stab_search(const timestamp value, OutputIterator output) const
+    {
+        stab_operations<OutputIterator> operations{*this, output};
+        if (frozen())
+        {
+            navigate_frozen_index(value, operations);
+        }
+        else
+        {
+            navigate_index(value, operations);
+        }
+        return operations.next_it;
+    }
+
+    /**
+     * Perform a batch of independent stabs: for every value in values and every
+     * event e active at value, write std::pair(value, e) to output. The results
+     * are written on ascending value (and, per value, in the order of
+     * stab_search). The values are sorted and navigated through the index in
+     * groups: the navigation of the values in a group is interleaved and the
+     * nodes and left-lists visited next are prefetched. Consecutive values
+     * share the progress made in the left-lists on their common path.
+     */
+    template <class OutputIterator>
+    void stab_search_batch(std::span<const timestamp> values, OutputIterator output) const
+    {
+        std::vector<timestamp> probes(values.begin(), values.end());
+        std::sort(probes.begin(), probes.end());
+
+        stab_batch_operations<OutputIterator> operations(*this, output);
+        std::array<std::vector<const_node_pointer>, stab_batch_group_size> paths;
+        for (size_type first = 0; first < probes.size(); first += stab_batch_group_size)
+        {
+            auto count = std::min(stab_batch_group_size, probes.size() - first);
+            auto group = probes.data() + first;
+            navigate_index_group(group, count, paths.data());
+            for (size_type i = 0; i < count; ++i)
+            {
+                navigate_path(group[i], paths[i], operations);
+            }
+        }
+    }
+
+    /**
+     * Return a stab-forward helper that allows for repeated stab and scan
+     * operations (on increasing start-times). Can be used to answer
+     * multi-stab-queries and multi-window-queries. The end-user can fine tune
+     * the stabbing behavior by setting the jump policy used (index jumps with
+     * a specified threshold factor or event-list jumps).
+     */
+    template <class OutputIterator, class JumpPolicy>
+    stab_forward_helper<OutputIterator, JumpPolicy> stab_forward_search(OutputIterator output,
+                                                                        const JumpPolicy &policy) const
+    {
+        return stab_forward_helper<OutputIterator, JumpPolicy>{*this, output, policy};
+    }
+
+    template <class OutputIterator, class JumpPolicy>
+    std::shared_ptr<stab_forward_helper<OutputIterator, JumpPolicy>> stab_forward_search_shared(OutputIterator output,
+        const JumpPolicy& policy) const
+    {
+        return std::shared_ptr<stab_forward_helper<OutputIterator, JumpPolicy>>(new stab_forward_helper<OutputIterator, JumpPolicy>(*this, output, policy));
+    }
+
+    /**
+     * Return the hieght of the index.
      */
     size_type index_height() const
     {
         return (index.empty()) ? 0 : index.front().height;
     }
 
+    /**
+     * Freeze the index: lay out the navigation keys of the index in a compact
+     * cache-line aligned implicit tree that is used by stab_search. Appending
+     * an event that adds a leaf to the index thaws the index again.
+     */
+    void freeze()
+    {
+        thaw();
+        if (index.empty())
+        {
+            return;
+        }
+
+        /* Every stab-tree of a forest-point of height h is a perfect binary
+         * tree with 2^h - 1 nodes and is stored in 2^h slots (slot zero is
+         * unused, such that the children of slot i are slots 2i and 2i + 1).
+         * The forest-points are ordered on decreasing height, hence every
+         * stab-tree starts at a multiple of its size and the siblings (and,
+         * when the keys are small enough, the grandchildren) of a node share a
+         * cache line. */
+        size_type slots = 0;
+        for (auto &fp : index)
+        {
+            frozen_points.push_back(frozen_point{frozen_key_of(fp), &fp, slots});
+            slots += size_type(1) << fp.height;
+        }
+        frozen_lines.resize((slots + frozen_keys_per_line - 1) / frozen_keys_per_line);
+        frozen_nodes.resize(slots, nullptr);
+
+        /* Place each stab-tree in breadth-first order (Eytzinger order). */
+        std::vector<const_node_pointer> level;
+        std::vector<const_node_pointer> next_level;
+        for (auto &point : frozen_points)
+        {
+            size_type slot = 1;
+            level.assign(1, point.node->left_ptr);
+            while (level.front() != nullptr)
+            {
+                next_level.clear();
+                for (auto node : level)
+                {
+                    frozen_key_at(point.offset + slot) = frozen_key_of(*node);
+                    frozen_nodes[point.offset + slot] = node;
+                    next_level.push_back(node->left_ptr);
+                    next_level.push_back(node->right_ptr);
+                    ++slot;
+                }
+                level.swap(next_level);
+            }
+        }
+    }
+
+    /**
+     * Return true if the index is frozen (see freeze).
+     */
+    bool frozen() const
+    {
+        return !frozen_points.empty();
+    }
+
 private:
     using event_array = raw_array<event>;
 
@@ -411,194 +1021,506 @@ private:
         node_pointer replacement_node;
     };
 
-    /* Return the begin() and end() iterators to the left-list (navigation key),
-     * sorted on ascending start-time order. */
-    template <class Node>
-    static auto nll_sa_begin(Node &node) { return node.ll_raw_data.data(); }
-    template <class Node>
-    static auto nll_sa_end(Node &node) { return node.ll_raw_data.data() + node.nll_size; }
+    /**
+     * Query and navigate the stab-forest using the index (see
+     * stab_navigation::navigate_index).
+     */
+    template <class NavigateOperations, class... Other>
+    void navigate_index(const timestamp value,
+                        NavigateOperations &op, Other &...other) const
+    {
+        navigation::template navigate_index<stab_tree_node>(index, min_key, value, op, other...);
+    }
 
-    /* Return the begin() and end() iterators to the left-list (data key),
-     * sorted on descending end-time order. */
-    template <class Node>
-    static auto dll_ed_begin(Node &node) { return node.ll_raw_data.data() + node.nll_size; }
-    template <class Node>
-    static auto dll_ed_end(Node &node) { return node.ll_raw_data.data() + node.ll_size; }
+    /*
+     * The frozen index. The navigation keys of the stab-tree nodes are stored
+     * together with a summary of their left-lists (the smallest start-time in
+     * the ascending start-time ordered left-list and the largest end-time in
+     * the descending end-time ordered left-lists), such that navigation only
+     * touches the stab-tree node itself (the payload) when its left-lists hold
+     * events that are active at the searched value.
+     */
+    struct frozen_key
+    {
+        timestamp nkey;
+        timestamp dkey;
+        timestamp min_start;
+        timestamp max_end;
+    };
 
-    /* Return the begin() and end() iterators to the left-list (navigation key),
-     * sorted on descending end-time order. */
-    template <class Node>
-    static auto nll_ed_begin(Node &node) { return node.ll_raw_data.data() + node.ll_size; }
-    template <class Node>
-    static auto nll_ed_end(Node &node) { return node.ll_raw_data.data() + node.ll_size + node.nll_size; }
+    static constexpr size_type frozen_line_size = 64;
+    static constexpr size_type frozen_keys_per_line = frozen_line_size / sizeof(frozen_key);
+    static_assert(frozen_line_size % sizeof(frozen_key) == 0, "frozen keys must pack a cache line");
+
+    struct alignas(frozen_line_size) frozen_line
+    {
+        frozen_key keys[frozen_keys_per_line];
+    };
+
+    struct frozen_point
+    {
+        /* The navigation keys of the forest-point itself. */
+        frozen_key key;
+
+        /* The forest-point. */
+        const forest_point *node;
+
+        /* The first slot of the stab-tree of the forest-point. */
+        size_type offset;
+    };
 
     /**
-     * Copy events in [first, last) to output that start before the specified
-     * value v (and start at-or-after mstart) from an ascending start-time
-     * ordered list of events; return an iterator pointing to the first value
-     * not copied. Observe that these functions do not return output iterators,
-     * making these functions work differently form the std::copy-family.
+     * Return the navigation keys and left-list summary of node. The summary of
+     * an empty left-list never matches, as every value navigated to in the
+     * frozen index is larger than min_key (and, hence, than zero).
      */
-    template <class InIt, class OutIt>
-    static InIt copy_start_asc(InIt first, InIt last, OutIt output, const timestamp v)
+    static frozen_key frozen_key_of(const stab_tree_node &node)
     {
-        while (first != last && first->start <= v)
+        frozen_key key{node.nkey, node.dkey, std::numeric_limits<timestamp>::max(), 0};
+        if (node.nll_size != 0)
         {
-            *output++ = *first++;
+            key.min_start = nll_sa_begin(node)->start;
+            key.max_end = nll_ed_begin(node)->end;
         }
-        return first;
+        if (node.ll_size != node.nll_size)
+        {
+            key.max_end = std::max(key.max_end, dll_ed_begin(node)->end);
+        }
+        return key;
     }
-    template <class InIt, class OutIt>
-    static InIt copy_start_asc(InIt first, InIt last, OutIt output, const timestamp v, const timestamp mstart)
+
+    frozen_key &frozen_key_at(const size_type slot)
     {
-        while (first != last && first->start < mstart)
+        return frozen_lines[slot / frozen_keys_per_line].keys[slot % frozen_keys_per_line];
+    }
+    const frozen_key &frozen_key_at(const size_type slot) const
+    {
+        return frozen_lines[slot / frozen_keys_per_line].keys[slot % frozen_keys_per_line];
+    }
+
+    /**
+     * Release the frozen index.
+     */
+    void thaw()
+    {
+        frozen_points.clear();
+        frozen_lines.clear();
+        frozen_nodes.clear();
+    }
+
+    /**
+     * Query and navigate the stab-forest using the frozen index. This works
+     * as navigate_index, except that op.left_child() and op.right_child() are
+     * only called on nodes whose left-lists hold events that start at-or-before
+     * and end at-or-after value, respectively (as is sufficient for the
+     * stab_search operations).
+     */
+    template <class NavigateOperations>
+    void navigate_frozen_index(const timestamp value, NavigateOperations &op) const
+    {
+        if (value <= min_key)
         {
-            ++first;
+            op.before_trees(value);
+            return;
+        }
+        else if (value > index.back().dkey)
+        {
+            op.after_trees(value);
+            return;
+        }
+
+        /* Navigate the forest-points. */
+        auto point = frozen_points.begin();
+        while (point->key.dkey < value)
+        {
+            if (value <= point->key.max_end)
+            {
+                op.right_child(*point->node, value);
+            }
+            ++point;
+        }
+        if (point->key.nkey <= value)
+        {
+            op.select_node(*point->node, value);
+            return;
+        }
+        else if (point->key.min_start <= value)
+        {
+            op.left_child(*point->node, value);
+        }
+
+        /* Navigate the stab-tree of the forest-point. */
+        const size_type offset = point->offset;
+        const size_type slots = size_type(1) << point->node->height;
+        size_type slot = 1;
+        while (true)
+        {
+            if (4 * slot < slots)
+            {
+                prefetch_read(&frozen_key_at(offset + 4 * slot));
+            }
+
+            const frozen_key &key = frozen_key_at(offset + slot);
+            if (key.nkey <= value && value <= key.dkey)
+            {
+                op.select_node(*frozen_nodes[offset + slot], value);
+                return;
+            }
+            else if (value < key.nkey)
+            {
+                if (key.min_start <= value)
+                {
+                    op.left_child(*frozen_nodes[offset + slot], value);
+                }
+                slot = 2 * slot;
+            }
+            else
+            {
+                if (value <= key.max_end)
+                {
+                    op.right_child(*frozen_nodes[offset + slot], value);
+                }
+                slot = 2 * slot + 1;
+            }
         }
-        return copy_start_asc(first, last, output, v);
     }
 
+    /* The number of values of which stab_search_batch interleaves the
+     * navigation. */
+    static constexpr size_type stab_batch_group_size = 8;
+
     /**
-     * Copy events in [first, last) to output that end after the specified
-     * value v (and start at-or-after mstart) from an descending end-time
-     * ordered list of events; return an iterator pointing to the first value
-     * not copied. Observe that these functions do not return output iterators,
-     * making these functions work differently form the std::copy-family.
+     * Navigate the index for each of the count values (at most
+     * stab_batch_group_size) and store the nodes visited for values[i] in
+     * paths[i] (empty if the value is not indexed by the forest). The values
+     * are navigated in an interleaved manner: after navigating one level for
+     * one value, the next node and the left-list that will be processed are
+     * prefetched while the other values are navigated.
      */
-    template <class InIt, class OutIt>
-    static InIt copy_end_dec(InIt first, InIt last, OutIt output, const timestamp v)
+    void navigate_index_group(const timestamp *values, const size_type count,
+                              std::vector<const_node_pointer> *paths) const
     {
-        while (first != last && first->end >= v)
+        std::array<const_node_pointer, stab_batch_group_size> current;
+        size_type active = 0;
+        for (size_type i = 0; i < count; ++i)
         {
-            *output++ = *first++;
+            paths[i].clear();
+            current[i] = nullptr;
+            if (min_key < values[i] && !index.empty() && values[i] <= index.back().dkey)
+            {
+                current[i] = &index.front();
+                paths[i].push_back(current[i]);
+                ++active;
+            }
+        }
+
+        while (active != 0)
+        {
+            for (size_type i = 0; i < count; ++i)
+            {
+                auto node = current[i];
+                if (node == nullptr)
+                {
+                    continue;
+                }
+
+                auto value = values[i];
+                if (value < node->nkey)
+                {
+                    prefetch_read(nll_sa_begin(*node));
+                    node = node->left_ptr;
+                }
+                else
+                {
+                    prefetch_read(dll_ed_begin(*node));
+                    if (value <= node->dkey)
+                    {
+                        current[i] = nullptr;
+                        --active;
+                        continue;
+                    }
+                    node = node->right_ptr;
+                }
+
+                prefetch_read(node);
+                paths[i].push_back(node);
+                current[i] = node;
+            }
         }
-        return first;
     }
-    template <class InIt, class OutIt>
-    static InIt copy_end_dec(InIt first, InIt last, OutIt output, const timestamp v, const timestamp mstart)
+
+    /**
+     * Perform the navigation operations of navigate_index for value on the
+     * provided path, as determined by navigate_index_group.
+     */
+    template <class NavigateOperations>
+    void navigate_path(const timestamp value, const std::vector<const_node_pointer> &path,
+                       NavigateOperations &op) const
     {
-        while (first != last && first->end >= v)
+        if (path.empty())
         {
-            if (mstart <= first->start)
+            if (value <= min_key)
             {
-                *output++ = *first;
+                op.before_trees(value);
             }
-            ++first;
+            else
+            {
+                op.after_trees(value);
+            }
+            return;
         }
-        return first;
+
+        for (auto it = path.begin(); it + 1 != path.end(); ++it)
+        {
+            if (value < (*it)->nkey)
+            {
+                op.left_child(**it, value);
+            }
+            else
+            {
+                op.right_child(**it, value);
+            }
+        }
+        op.select_node(*path.back(), value);
     }
 
+    /* Classes supporting stab-forest querying and navigation (implementing
+     * NavigateOperations as used by the navigate_index and
+     * navigate_stab_tree_node functions). */
+    template <class OutputIterator>
+    using stab_operations = basic_stab_operations<stab_forest_type, OutputIterator>;
+    template <class OutputIterator>
+    using stab_batch_operations = basic_stab_batch_operations<stab_forest_type, OutputIterator>;
+    struct probe_operations;
+
     /**
-     * Query and navigate the stab-forest using the index. This will search for
-     * the node for which nkey <= value <= dkey holds. This method uses
-     * callbacks to perform the necessary actions on each visited forest-point
-     * and stab-tree node. The following methods should be provided:
-     *
-     *   op.before_trees(value, other...) is called when value is smaller or
-     *     equal to the smallest start-time present in the stab-forest.
-     *   op.after_trees(value, other...) is called when value is larger than the
-     *     largest start-time present in the stab-forest (but not necessary
-     *     larger than the start-times of events in the event-list tail).
-     *   op.left_child(node, value, other...) is called to indicate that the
-     *     search will navigate to the left child of the specified node.
-     *   op.right_child(node, value, other...) is analogous to left_child.
-     *   op.select_node(node, value, other...) is called when node is the node
-     *     for which nkey <= value <= dkey holds.
-     *
-     * The methods before_trees, after_trees, and select_node are only called
-     * when the search has finished. The other... parameters are simply passed
-     * on to the callback functions.
+     * Construct a new forest-point representing a leaf (when the current
+     * event-list tail needs to be incorporated into the index).
      */
-    template <class NavigateOperations, class... Other>
-    void navigate_index(const timestamp value,
-                        NavigateOperations &op, Other &...other) const
+    void build_leaf_forest_point()
     {
-        /* Value not in the tree or the left-most timestamp. */
-        if (value <= min_key)
+        thaw();
+
+        /* Collect left-list details. */
+        auto first = unstabilize_pointer(tail_pointer);
+        auto last = event_list.cend();
+        auto stable_end = stabilize_iterator(event_list.cend());
+        timestamp key = first->start;
+
+        /* Make the new leaf node and tree root. */
+        auto nkey = (!index.empty()) ? index.back().dkey + 1 : key;
+        auto &leaf = nodes.emplace_back(nkey, key, nullptr, nullptr, 0u,
+                                        tail_pointer, stable_end, 0u, 0u, 0u);
+
+        /* Add a root for this new tree. */
+        auto ml_rbegin = std::make_reverse_iterator(last);
+        auto ml_rend = std::make_reverse_iterator(first);
+
+        size_type size = std::distance(first, last);
+        auto &fp = index.emplace_back(&leaf,
+                                      nkey, key, nullptr, nullptr, 0u,
+                                      tail_pointer, stable_end, 0u, size, size);
+
+        std::copy(ml_rbegin, ml_rend, dll_ed_begin(fp));
+
+        tail_pointer = stable_end;
+        maintain_index();
+    }
+
+    /**
+     * Fill the empty stab forest with the sorted events in [first, last) and
+     * build the index bottom-up (see the bulk-load constructor).
+     */
+    template <class InputIt>
+    void bulk_load(InputIt first, InputIt last, const size_type num_threads)
+    {
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category> &&
+                      requires(typename event_list_base::event_list_type &list, size_type n) { list.reserve(n); })
         {
-            op.before_trees(value, other...);
+            event_list.reserve(std::distance(first, last));
+        }
+        for (; first != last; ++first)
+        {
+            event_list.emplace_back(*first);
+        }
+        if (event_list.empty())
+        {
+            return;
         }
 
-        /* Value is indexed by the forest. */
-        else if (!index.empty() && value <= index.back().dkey)
+        /* Split the event-list into groups of events with equal start-time.
+         * Every group but the last one becomes a leaf, the last one remains in
+         * the event-list tail (as append_event would have left it). */
+        std::vector<stable_event_pointer> group_begin;
+        timestamp key = event_list.cbegin()->start;
+        group_begin.push_back(stabilize_iterator(event_list.cbegin()));
+        for (auto it = std::next(event_list.cbegin()); it != event_list.cend(); ++it)
+        {
+            if (it->start != key)
+            {
+                key = it->start;
+                group_begin.push_back(stabilize_iterator(it));
+            }
+        }
+        min_key = event_list.cbegin()->start;
+        tail_pointer = group_begin.back();
+
+        /* Construct the leaf nodes; these are constructed in start-time order,
+         * exactly as build_leaf_forest_point does. */
+        size_type leaf_count = group_begin.size() - 1;
+        std::vector<node_pointer> leaves;
+        leaves.reserve(leaf_count);
+        timestamp nkey = min_key;
+        for (size_type i = 0; i < leaf_count; ++i)
         {
-            navigate_stab_tree_node(&index.front(), value, op, other...);
+            key = unstabilize_pointer(group_begin[i])->start;
+            leaves.push_back(&nodes.emplace_back(nkey, key, nullptr, nullptr, 0u,
+                                                 group_begin[i], group_begin[i + 1], 0u, 0u, 0u));
+            nkey = key + 1;
         }
 
-        /* Value after the last start time in the last tree. */
-        else
+        /* Decompose the leaves, as maintain_index would, into complete
+         * stab-trees of 2^h leaves for every bit h set in leaf_count (highest
+         * bit first). Every stab-tree is built depth-first, which performs the
+         * same merges in the same order as appending would. To build in
+         * parallel, stab-trees with more than 2^split leaves are split into
+         * subtrees of 2^split leaves that are built concurrently. */
+        size_type split = std::numeric_limits<size_type>::digits;
+        if (num_threads > 1)
         {
-            op.after_trees(value, other...);
+            split = 0;
+            while ((leaf_count >> (split + 1)) >= 8 * num_threads)
+            {
+                ++split;
+            }
+        }
+
+        std::vector<std::pair<size_type, size_type>> trees;
+        std::vector<std::pair<size_type, size_type>> subtrees;
+        for (size_type height = std::numeric_limits<size_type>::digits, first_leaf = 0; height-- > 0;)
+        {
+            size_type tree_size = size_type(1) << height;
+            if ((leaf_count & tree_size) != 0)
+            {
+                trees.emplace_back(first_leaf, height);
+                size_type step = size_type(1) << std::min(height, split);
+                for (size_type leaf = first_leaf; leaf < first_leaf + tree_size; leaf += step)
+                {
+                    subtrees.emplace_back(leaf, std::min(height, split));
+                }
+                first_leaf += tree_size;
+            }
+        }
+
+        std::vector<std::optional<forest_point>> subtree_fps(subtrees.size());
+        parallel_for_index(subtrees.size(), num_threads, [&](const size_type i) {
+            subtree_fps[i].emplace(build_stab_tree(leaves, subtrees[i].first, subtrees[i].second));
+        });
+
+        /* Merge the subtrees of each stab-tree pairwise, put the resulting
+         * forest-points in the index, and link them. */
+        auto subtree_it = subtree_fps.begin();
+        forest_point *previous = nullptr;
+        for (auto &tree : trees)
+        {
+            size_type count = size_type(1) << (tree.second - std::min(tree.second, split));
+            std::vector<std::optional<forest_point>> level(std::make_move_iterator(subtree_it),
+                                                           std::make_move_iterator(subtree_it + count));
+            subtree_it += count;
+            while (level.size() > 1)
+            {
+                std::vector<std::optional<forest_point>> next(level.size() / 2);
+                parallel_for_index(next.size(), num_threads, [&](const size_type i) {
+                    next[i].emplace(merged_forest_point(*level[2 * i], *level[2 * i + 1]));
+                });
+                level = std::move(next);
+            }
+
+            auto &fp = index.emplace_back(std::move(*level.front()));
+            if (previous != nullptr)
+            {
+                previous->right_ptr = &fp;
+            }
+            previous = &fp;
         }
     }
 
     /**
-     * Query and navigate a stab-tree. This method assumes that node has a
-     * descendant for which nkey <= value <= dkey holds. See navigate_index
-     * on the details of the navigation operations (we only use op.left_child(),
-     * op.right_child(), and op.select_node()).
+     * Build the stab-tree holding the 2^height leaves starting at leaves[first]
+     * and return the forest-point representing it.
      */
-    template <class NavigateOperations, class... Other>
-    void navigate_stab_tree_node(const_node_pointer node, timestamp value,
-                                 NavigateOperations &op, Other &...other) const
+    forest_point build_stab_tree(const std::vector<node_pointer> &leaves,
+                                 const size_type first, const size_type height) const
     {
-        /* Traverse the forest until the node is found for which value is
-         * active at [nkey, dkey]. */
-        while (!(node->nkey <= value && value <= node->dkey))
+        if (height == 0)
         {
-            if (value < node->nkey)
-            {
-                op.left_child(*node, value, other...);
-                node = node->left_ptr;
-            }
-            else
+            node_pointer leaf = leaves[first];
+            auto lfirst = unstabilize_pointer(leaf->data_begin);
+            auto llast = unstabilize_pointer(leaf->data_end);
+            size_type size = std::distance(lfirst, llast);
+            forest_point fp(leaf,
+                            leaf->nkey, leaf->dkey, nullptr, nullptr, 0u,
+                            leaf->data_begin, leaf->data_end, 0u, size, size);
+            std::copy(std::make_reverse_iterator(llast), std::make_reverse_iterator(lfirst),
+                      dll_ed_begin(fp));
+            return fp;
+        }
+
+        forest_point left = build_stab_tree(leaves, first, height - 1);
+        forest_point right = build_stab_tree(leaves, first + (size_type(1) << (height - 1)), height - 1);
+        return merged_forest_point(left, right);
+    }
+
+    /**
+     * Call f(i) for every i in [0, n), distributing the calls over (at most)
+     * num_threads threads. Small workloads are processed by the calling thread.
+     */
+    template <class Function>
+    static void parallel_for_index(const size_type n, const size_type num_threads, Function f)
+    {
+        if (num_threads <= 1 || n < 2 * num_threads)
+        {
+            for (size_type i = 0; i < n; ++i)
             {
-                op.right_child(*node, value, other...);
-                node = node->right_ptr;
+                f(i);
             }
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads);
+        for (size_type t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back([&f, t, n, num_threads]() {
+                for (size_type i = t * n / num_threads; i < (t + 1) * n / num_threads; ++i)
+                {
+                    f(i);
+                }
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
         }
-
-        /* The node is found. */
-        op.select_node(*node, value, other...);
     }
 
-    /* Classes supporting stab-forest querying and navigation (implementing
-     * NavigateOperations as used by the navigate_index and
-     * navigate_stab_tree_node functions). */
-    template <class OutputIterator>
-    struct stab_operations;
-    struct probe_operations;
-
     /**
-     * Construct a new forest-point representing a leaf (when the current
-     * event-list tail needs to be incorporated into the index).
+     * Return true if all events in the stab-tree of the forest-point end before
+     * value. The max-list of a forest-point holds all events of its stab-tree
+     * that end at-or-after the navigation key of the forest-point.
      */
-    void build_leaf_forest_point()
+    static bool ended_before(const forest_point &fp, const timestamp value)
     {
-        /* Collect left-list details. */
-        auto first = unstabilize_pointer(tail_pointer);
-        auto last = event_list.cend();
-        auto stable_end = stabilize_iterator(event_list.cend());
-        timestamp key = first->start;
-
-        /* Make the new leaf node and tree root. */
-        auto nkey = (!index.empty()) ? index.back().dkey + 1 : key;
-        auto &leaf = nodes.emplace_back(nkey, key, nullptr, nullptr, 0u,
-                                        tail_pointer, stable_end, 0u, 0u, 0u);
-
-        /* Add a root for this new tree. */
-        auto ml_rbegin = std::make_reverse_iterator(last);
-        auto ml_rend = std::make_reverse_iterator(first);
-
-        size_type size = std::distance(first, last);
-        auto &fp = index.emplace_back(&leaf,
-                                      nkey, key, nullptr, nullptr, 0u,
-                                      tail_pointer, stable_end, 0u, size, size);
-
-        std::copy(ml_rbegin, ml_rend, dll_ed_begin(fp));
-
-        tail_pointer = stable_end;
-        maintain_index();
+        if (fp.nll_size != 0 && value <= nll_ed_begin(fp)->end)
+        {
+            return false;
+        }
+        if (fp.ll_size != fp.nll_size && value <= dll_ed_begin(fp)->end)
+        {
+            return false;
+        }
+        return fp.nkey <= value;
     }
 
     /**
@@ -630,6 +1552,21 @@ private:
      * Merge the forest-points.
      */
     void merge_forest_points(forest_point &left, forest_point &right)
+    {
+        /* Remove the old forest-points and put the new forest-point. */
+        forest_point fp = merged_forest_point(left, right);
+        index.pop_back();
+        index.pop_back();
+        index.emplace_back(std::move(fp));
+    }
+
+    /**
+     * Merge the forest-points left and right (of equal height, left preceding
+     * right) and return the resulting forest-point. Only the replacement node
+     * of left is updated: merges of distinct pairs of forest-points can be
+     * performed concurrently.
+     */
+    static forest_point merged_forest_point(forest_point &left, forest_point &right)
     {
         node_pointer root = left.replacement_node;
         node_pointer fp_node = right.replacement_node;
@@ -693,16 +1630,15 @@ private:
                         nll_ed_begin(right), nll_ed_end(right),
                         ml_it, event::end_compare(std::greater<>()));
 
-        /* Remove the old forest-points and construct the new forest-point. */
-        index.pop_back();
-        index.pop_back();
-        index.emplace_back(fp_node,
-                           fp_node->nkey, fp_node->dkey, root, nullptr, root->height + 1,
-                           fp_node->data_begin, fp_node->data_end,
-                           right.nll_size + ml_add_size, right.ll_size + ml_add_size, std::move(raw_max_list));
+        /* Construct the new forest-point. */
+        forest_point fp(fp_node,
+                        fp_node->nkey, fp_node->dkey, root, nullptr, root->height + 1,
+                        fp_node->data_begin, fp_node->data_end,
+                        right.nll_size + ml_add_size, right.ll_size + ml_add_size, std::move(raw_max_list));
         root->nll_size = nll_size;
         root->ll_size = nll_size + dll_size;
         root->ll_raw_data.swap(raw_left_list);
+        return fp;
     }
 
     /* The stab-tree nodes used in the stab-forest index. */
@@ -716,6 +1652,12 @@ private:
 
     /* The start-time of the first event in the event list. */
     timestamp min_key;
+
+    /* The frozen index (empty if the index is not frozen): the forest-points,
+     * the navigation keys of the stab-tree nodes, and the stab-tree nodes. */
+    std::vector<frozen_point> frozen_points;
+    std::vector<frozen_line> frozen_lines;
+    std::vector<const_node_pointer> frozen_nodes;
 };
 
 /**
@@ -726,51 +1668,68 @@ private:
  * and starts at-or-after the current start-time is written to the a provided
  * output iterator. The stab-forward helper is only valid when the underlying
  * stab-forest is still in scope and no additional events have been appended to
- * the stab-forest.
+ * the stab-forest (stab-forward helpers on a published stab_forest_snapshot
+ * remain valid while events are appended to the concurrent_stab_forest).
  */
-template <class TimeStampType, template <class> class EventList>
-template <class OutputIterator, class JumpPolicy>
-class stab_forest<TimeStampType, EventList>::stab_forward_helper : private JumpPolicy
+template <class StabForest, class OutputIterator, class JumpPolicy>
+class basic_stab_forward_helper : private JumpPolicy
 {
 private:
+    using stab_forest_type = StabForest;
+    using timestamp = typename stab_forest_type::timestamp;
+    using event = typename stab_forest_type::event;
+    using const_iterator = typename stab_forest_type::const_iterator;
+    using size_type = typename stab_forest_type::size_type;
+    using stab_tree_node = typename stab_forest_type::stab_tree_node;
+    using const_node_pointer = const stab_tree_node *;
+
+    /* Index navigation prefetches nodes and left-lists (see
+     * stab_navigation::navigate_stab_tree_node). */
+    static constexpr bool prefetch_navigation = std::is_same_v<JumpPolicy, stab_forward_prefetch>;
+
+    /* The event-list supports random access. */
+    static constexpr bool random_access = std::is_base_of_v<std::random_access_iterator_tag,
+                                                            typename std::iterator_traits<const_iterator>::iterator_category>;
+
     /**
      * Construct an initial stab-forward helper. This constructor is used by the
      * stab-forest itself. After initial construction, this class can be moved
      * using the move-constructor.
      */
-    stab_forward_helper(const stab_forest_type &forest, OutputIterator output, const JumpPolicy &policy) : JumpPolicy(policy),
-                                                                                                           forest(forest),
-                                                                                                           output(output),
-                                                                                                           event_list_it(forest.cbegin()),
-                                                                                                           went_left(false),
-                                                                                                           first_left_parent(nullptr),
-                                                                                                           visited_nodes(forest.index.empty() ? 0u : forest.index_height() + 1),
-                                                                                                           start_asc_it(visited_nodes.size()) {}
+    basic_stab_forward_helper(const stab_forest_type &forest, OutputIterator output, const JumpPolicy &policy) : JumpPolicy(policy),
+                                                                                                                 forest(forest),
+                                                                                                                 output(output),
+                                                                                                                 event_list_it(forest.cbegin()),
+                                                                                                                 went_left(false),
+                                                                                                                 first_left_parent(nullptr),
+                                                                                                                 visited_nodes(forest.index.empty() ? 0u : forest.index_height() + 1),
+                                                                                                                 start_asc_it(visited_nodes.size()) {}
 
     friend stab_forest_type;
+    friend class stab_navigation<timestamp>;
 
 public:
     /**
      * Move-constructor.
      */
-    stab_forward_helper(stab_forward_helper &&other) : JumpPolicy(other),
-                                                       forest(other.forest),
-                                                       output(std::move(output)),
-                                                       event_list_it(other.event_list_it),
-                                                       went_left(other.went_left),
-                                                       first_left_parent(other.first_left_parent),
-                                                       visited_nodes(std::move(other.visited_nodes)),
-                                                       start_asc_it(std::move(other.start_asc_it)) {}
+    basic_stab_forward_helper(basic_stab_forward_helper &&other) : JumpPolicy(other),
+                                                             forest(other.forest),
+                                                             output(std::move(other.output)),
+                                                             event_list_it(other.event_list_it),
+                                                             went_left(other.went_left),
+                                                             first_left_parent(other.first_left_parent),
+                                                             visited_nodes(std::move(other.visited_nodes)),
+                                                             start_asc_it(std::move(other.start_asc_it)) {}
 
     /**
      * No copy-constructor.
      */
-    stab_forward_helper(const stab_forward_helper &other) = delete;
+    basic_stab_forward_helper(const basic_stab_forward_helper &other) = delete;
 
     /**
      * No assignment.
      */
-    stab_forward_helper &operator=(const stab_forward_helper &other) = delete;
+    basic_stab_forward_helper &operator=(const basic_stab_forward_helper &other) = delete;
 
     /* Forward-iterator-like interface. */
     using value_type = event;
@@ -792,13 +1751,13 @@ public:
     /**
      * Read the current event in the event-list.
      */
-    const value_type &operator*() const
+    decltype(auto) operator*() const
     {
         return *event_list_it;
     }
-    const value_type *operator->() const
+    const_iterator operator->() const
     {
-        return &*event_list_it;
+        return event_list_it;
     }
 
     /**
@@ -851,8 +1810,8 @@ public:
     /**
      * Return forest.stab_search, see stab_forest::stab_search
      */
-    template <class OutputIterator>
-    const_iterator stab_search(const timestamp value, OutputIterator output) const
+    template <class StabOutputIterator>
+    const_iterator stab_search(const timestamp value, StabOutputIterator output) const
     {
         return forest.stab_search(value, output);
     }
@@ -904,6 +1863,16 @@ private:
         index_stab_forward(value, it);
     }
 
+    void policy_stab_forward(const timestamp value, const stab_forward_prefetch&)
+    {
+        index_stab_forward(value, &event_list_it);
+    }
+
+    void policy_stab_forward(const timestamp value, const stab_forward_prefetch&, const_iterator* it)
+    {
+        index_stab_forward(value, it);
+    }
+
     void policy_stab_forward(const timestamp value, const stab_forward_list&)
     {
         list_stab_forward(value, &event_list_it);
@@ -920,43 +1889,206 @@ private:
     }
 
     void policy_stab_forward(const timestamp value, const stab_forward_check&, const_iterator* it)
+    {
+        if (skip_within(value, *it, this->threshold))
+        {
+            list_stab_forward(value, it);
+        }
+        else
+        {
+            index_stab_forward(value, it);
+        }
+    }
+
+    void policy_stab_forward(const timestamp value, const stab_forward_gallop& g)
+    {
+        policy_stab_forward(value, g, &event_list_it);
+    }
+
+    void policy_stab_forward(const timestamp value, const stab_forward_gallop& g, const_iterator* it)
+    {
+        if constexpr (random_access)
+        {
+            auto first = *it;
+            auto end = forest.cend();
+            if (first == end || value < first->start)
+            {
+                return;
+            }
+
+            /* Gallop to a range [first + low, first + high) holding the first
+             * event that starts after value; first[low] starts at-or-before
+             * value. */
+            size_type size = end - first;
+            size_type low = 0;
+            size_type high = 1;
+            while (high < size && first[high].start <= value)
+            {
+                low = high;
+                high *= 2;
+            }
+            high = std::min(high, size);
+            auto last = std::upper_bound(first + (low + 1), first + high, value,
+                                         [](const timestamp v, const auto &e) { return v < e.start; });
+
+            /* Check the skipped events, or recover the skipped events that
+             * are still active using the index. */
+            if (static_cast<size_type>(last - first) <= g.threshold)
+            {
+                for (; first != last; ++first)
+                {
+                    if (value <= first->end)
+                    {
+                        *output++ = *first;
+                    }
+                }
+            }
+            else
+            {
+                stab_skipped(value, first);
+            }
+            *it = last;
+        }
+        else
+        {
+            list_stab_forward(value, it);
+        }
+    }
+
+    void policy_stab_forward(const timestamp value, stab_forward_adaptive& a)
+    {
+        policy_stab_forward(value, a, &event_list_it);
+    }
+
+    void policy_stab_forward(const timestamp value, stab_forward_adaptive& a, const_iterator* it)
+    {
+        using clock = stab_forward_adaptive::clock;
+
+        /* Scan the event-list for at most threshold events. */
+        if (!(random_access && a.direct_index()))
+        {
+            if (++a.list_calls % stab_forward_adaptive::list_sample_period != 0)
+            {
+                list_stab_forward(value, it, a.threshold);
+            }
+            else
+            {
+                auto start = clock::now();
+                auto events = list_stab_forward(value, it, a.threshold);
+                a.add_list_sample(std::chrono::duration<double, std::nano>(clock::now() - start).count(), events);
+            }
+            if (*it == forest.cend() || value < (*it)->start)
+            {
+                return;
+            }
+        }
+        adaptive_index_stab_forward(value, a, it);
+    }
+
+    /**
+     * Perform the index jump of the adaptive jump policy.
+     */
+    void adaptive_index_stab_forward(const timestamp value, stab_forward_adaptive& a, const_iterator* it)
+    {
+        using clock = stab_forward_adaptive::clock;
+
+        auto first = *it;
+        if (++a.index_calls % stab_forward_adaptive::index_sample_period != 0)
+        {
+            index_stab_forward(value, it);
+        }
+        else
+        {
+            auto start = clock::now();
+            index_stab_forward(value, it);
+            a.add_index_sample(std::chrono::duration<double, std::nano>(clock::now() - start).count());
+        }
+        if constexpr (random_access)
+        {
+            a.add_index_skip(static_cast<std::size_t>(*it - first));
+        }
+    }
+
+    /**
+     * Write the events that start at-or-after first (and, hence, not before
+     * the first event with the start-time of first) and are active at value
+     * using the left-lists and max-lists of the index. The position in the
+     * event-list is not changed.
+     */
+    void stab_skipped(const timestamp value, const const_iterator first)
+    {
+        basic_stab_operations<stab_forest_type, OutputIterator &> operations{forest, output, first};
+        if (first == forest.cbegin())
+        {
+            forest.navigate_index(value, operations);
+        }
+        else
+        {
+            auto start_at_after = first->start;
+            forest.navigate_index(value, operations, start_at_after);
+        }
+    }
+
+    /**
+     * Return true if at most n events from it start at-or-before value (such
+     * that an event-list scan from it to value visits at most n events).
+     * For non-random-access event-lists, the events are visited one-by-one.
+     */
+    bool skip_within(const timestamp value, const_iterator it, const size_type n) const
     {
         auto end = forest.cend();
-        size_type d = std::distance(it, end);
-        if (d <= this->threshold || value <= it[this->threshold].start)
+        if constexpr (random_access)
         {
-            list_stab_forward(value, &it);
+            return static_cast<size_type>(end - it) <= n || value < it[n].start;
         }
         else
         {
-            index_stab_forward(value, &it);
+            for (size_type i = 0; i < n; ++i, ++it)
+            {
+                if (it == end || value < it->start)
+                {
+                    return true;
+                }
+            }
+            return it == end || value < it->start;
         }
     }
 
     /**
-     * Perform stab-forward using the index.
+     * Perform stab-forward using the index. The navigation callbacks operate
+     * on event_list_it, hence it is moved to event_list_it (and back).
      */
     void index_stab_forward(const timestamp value, const_iterator* it)
     {
+        /* No events start at-or-after the end of the event-list. */
+        if (*it == forest.cend())
+        {
+            return;
+        }
+
         went_left = false;
+        if (it != &event_list_it)
+        {
+            event_list_it = *it;
+        }
 
         /* We have not yet visited anything, hence, initialize a stab. */
         if (first_left_parent == nullptr)
         {
-            if (*it == forest.cbegin())
+            if (event_list_it == forest.cbegin())
             {
                 forest.navigate_index(value, *this);
             }
             else
             {
-                forest.navigate_index(value, *this, (*it)->start);
+                forest.navigate_index(value, *this, event_list_it->start);
             }
         }
 
         /* Continue after all data collected during the previous stab. */
         else
         {
-            auto start_at_after = (*it)->start;
+            auto start_at_after = event_list_it->start;
 
             /* Continue stabbing the tree. */
             if (value <= forest.index.back().dkey)
@@ -970,22 +2102,60 @@ private:
                 after_trees(value, start_at_after);
             }
         }
+
+        if (it != &event_list_it)
+        {
+            *it = event_list_it;
+        }
+    }
+
+    /**
+     * Perform stab-forward using the event-list; return the number of events
+     * visited.
+     */
+    size_type list_stab_forward(const timestamp value, const_iterator* it)
+    {
+        auto end = forest.cend();
+        size_type events = 0;
+        while (((*it) != end) && ((*it)->start <= value))
+        {
+            if (value <= (*it)->end)
+            {
+                *output++ = **it;
+            }
+            ++*it;
+            ++events;
+        }
+        return events;
     }
 
     /**
-     * Perform stab-forward using the event-list.
+     * Perform stab-forward using the event-list, but stop at the first event
+     * that starts after value or, after visiting at least limit events, at the
+     * first event with a start-time different from the previous event; return
+     * the number of events visited. As we stop at a start-time boundary, the
+     * stab-forward operation can be completed with index_stab_forward.
      */
-    void list_stab_forward(const timestamp value, const_iterator* it)
+    size_type list_stab_forward(const timestamp value, const_iterator* it, const size_type limit)
     {
         auto end = forest.cend();
+        size_type events = 0;
+        timestamp previous = 0;
         while (((*it) != end) && ((*it)->start <= value))
         {
+            if (events >= limit && (*it)->start != previous)
+            {
+                break;
+            }
+            previous = (*it)->start;
             if (value <= (*it)->end)
             {
                 *output++ = **it;
             }
-            it->operator++();
+            ++*it;
+            ++events;
         }
+        return events;
     }
 
     /* The stab_forward_helper uses the navigate_index and
@@ -1007,7 +2177,7 @@ private:
     template <class... Other>
     void before_trees(const timestamp value, Other... other)
     {
-        event_list_it = copy_start_asc(event_list_it, forest.event_list.cend(),
+        event_list_it = stab_forest_type::copy_start_asc(event_list_it, forest.event_list.cend(),
                                        output, value, other...);
     }
 
@@ -1046,7 +2216,7 @@ private:
         {
             auto rbegin = std::make_reverse_iterator(forest.event_list.cend());
             auto rend = std::make_reverse_iterator(tail_begin);
-            copy_end_dec(rbegin, rend, output, value, other...);
+            stab_forest_type::copy_end_dec(rbegin, rend, output, value, other...);
             event_list_it = forest.cend();
         }
     }
@@ -1064,7 +2234,7 @@ private:
 
         /* If we have not yet visited this node, then initialize the left-list
          * iterator to point to the first event. */
-        auto begin = nll_sa_begin(node);
+        auto begin = stab_forest_type::nll_sa_begin(node);
         if (visited_nodes[node.height] != &node)
         {
             visited_nodes[node.height] = &node;
@@ -1072,7 +2242,7 @@ private:
         }
 
         /* Perform the stab operation. */
-        start_asc_it[node.height] = copy_start_asc(start_asc_it[node.height], nll_sa_end(node),
+        start_asc_it[node.height] = stab_forest_type::copy_start_asc(start_asc_it[node.height], stab_forest_type::nll_sa_end(node),
                                                    output, value, other...);
     }
 
@@ -1080,8 +2250,8 @@ private:
     {
         /* This must be the first stab. Hence, we did not navigate to the right
          * child yet. Process the left-list ordered on descending end-times. */
-        copy_end_dec(dll_ed_begin(node), dll_ed_end(node), output, value);
-        copy_end_dec(nll_ed_begin(node), nll_ed_end(node), output, value);
+        stab_forest_type::copy_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), output, value);
+        stab_forest_type::copy_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), output, value);
         visited_nodes[node.height] = &node;
     }
 
@@ -1094,11 +2264,11 @@ private:
         visited_nodes[node.height] = &node;
         if (start_at_after <= node.dkey)
         {
-            copy_end_dec(dll_ed_begin(node), dll_ed_end(node), output, value, start_at_after);
+            stab_forest_type::copy_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), output, value, start_at_after);
         }
-        if (node.nkey != 0 && (start_at_after < node.nkey - 1))
+        if (start_at_after < node.nkey)
         {
-            copy_end_dec(nll_ed_begin(node), nll_ed_end(node), output, value, start_at_after);
+            stab_forest_type::copy_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), output, value, start_at_after);
         }
     }
 
@@ -1109,9 +2279,9 @@ private:
         visited_nodes[node.height] = &node;
         if (value == node.dkey)
         {
-            copy_end_dec(dll_ed_begin(node), dll_ed_end(node), output, value);
+            stab_forest_type::copy_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), output, value);
         }
-        copy_end_dec(nll_ed_begin(node), nll_ed_end(node), output, value);
+        stab_forest_type::copy_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), output, value);
         event_list_it = (value < node.dkey) ? forest.unstabilize_pointer(node.data_begin)
                                             : forest.unstabilize_pointer(node.data_end);
     }
@@ -1126,11 +2296,11 @@ private:
         visited_nodes[node.height] = &node;
         if (value == node.dkey)
         {
-            copy_end_dec(dll_ed_begin(node), dll_ed_end(node), output, value, start_at_after);
+            stab_forest_type::copy_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), output, value, start_at_after);
         }
-        if (node.nkey != 0 && (start_at_after < node.nkey - 1))
+        if (start_at_after < node.nkey)
         {
-            copy_end_dec(nll_ed_begin(node), nll_ed_end(node), output, value, start_at_after);
+            stab_forest_type::copy_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), output, value, start_at_after);
         }
         event_list_it = (value < node.dkey) ? forest.unstabilize_pointer(node.data_begin)
                                             : forest.unstabilize_pointer(node.data_end);
@@ -1140,25 +2310,36 @@ private:
 /**
  * The navigate_index callback structure used by stab_search.
  */
-template <class TimeStampType, template <class> class EventList>
-template <class OutputIterator>
-struct stab_forest<TimeStampType, EventList>::stab_operations
+template <class StabForest, class OutputIterator>
+struct basic_stab_operations
 {
+    using stab_forest_type = StabForest;
+    using timestamp = typename stab_forest_type::timestamp;
+    using const_iterator = typename stab_forest_type::const_iterator;
+    using stab_tree_node = typename stab_forest_type::stab_tree_node;
+
     const stab_forest_type &forest;
     OutputIterator output;
     const_iterator next_it;
 
-    void before_trees(const timestamp value)
+    /* The optional start_at_after parameter restricts the stab to the events
+     * that start at-or-after start_at_after; the left-lists of nodes whose
+     * events all start before start_at_after are skipped (see the stab-forward
+     * helper). */
+
+    template <class... Other>
+    void before_trees(const timestamp value, Other... other)
     {
-        next_it = copy_start_asc(forest.event_list.cbegin(), forest.event_list.cend(), output, value);
+        next_it = stab_forest_type::copy_start_asc(forest.event_list.cbegin(), forest.event_list.cend(), output, value, other...);
     }
 
-    void after_trees(const timestamp value)
+    template <class... Other>
+    void after_trees(const timestamp value, Other... other)
     {
         /* Search stab results in the max-lists of tree roots. */
         for (auto &fp : forest.index)
         {
-            right_child(fp, value);
+            right_child(fp, value, other...);
         }
 
         /* See if we need to include the event-list tail. */
@@ -1171,33 +2352,168 @@ struct stab_forest<TimeStampType, EventList>::stab_operations
         {
             auto rbegin = std::make_reverse_iterator(forest.event_list.cend());
             auto rend = std::make_reverse_iterator(tail_begin);
-            copy_end_dec(rbegin, rend, output, value);
+            stab_forest_type::copy_end_dec(rbegin, rend, output, value, other...);
             next_it = forest.cend();
         }
     }
 
-    void left_child(const stab_tree_node &node, const timestamp value)
+    template <class... Other>
+    void left_child(const stab_tree_node &node, const timestamp value, Other... other)
     {
-        copy_start_asc(nll_sa_begin(node), nll_sa_end(node), output, value);
+        stab_forest_type::copy_start_asc(stab_forest_type::nll_sa_begin(node), stab_forest_type::nll_sa_end(node), output, value, other...);
     }
 
     void right_child(const stab_tree_node &node, timestamp value)
     {
-        copy_end_dec(dll_ed_begin(node), dll_ed_end(node), output, value);
-        copy_end_dec(nll_ed_begin(node), nll_ed_end(node), output, value);
+        stab_forest_type::copy_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), output, value);
+        stab_forest_type::copy_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), output, value);
+    }
+
+    void right_child(const stab_tree_node &node, timestamp value, const timestamp start_at_after)
+    {
+        if (start_at_after <= node.dkey)
+        {
+            stab_forest_type::copy_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), output, value, start_at_after);
+        }
+        if (start_at_after < node.nkey)
+        {
+            stab_forest_type::copy_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), output, value, start_at_after);
+        }
     }
 
     void select_node(const stab_tree_node &node, const timestamp value)
     {
         if (value == node.dkey)
         {
-            copy_end_dec(dll_ed_begin(node), dll_ed_end(node), output, value);
+            stab_forest_type::copy_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), output, value);
+        }
+        stab_forest_type::copy_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), output, value);
+        next_it = (value < node.dkey) ? forest.unstabilize_pointer(node.data_begin)
+                                      : forest.unstabilize_pointer(node.data_end);
+    }
+
+    void select_node(const stab_tree_node &node, const timestamp value, const timestamp start_at_after)
+    {
+        if (value == node.dkey)
+        {
+            stab_forest_type::copy_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), output, value, start_at_after);
+        }
+        if (start_at_after < node.nkey)
+        {
+            stab_forest_type::copy_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), output, value, start_at_after);
         }
-        copy_end_dec(nll_ed_begin(node), nll_ed_end(node), output, value);
         next_it = (value < node.dkey) ? forest.unstabilize_pointer(node.data_begin)
                                       : forest.unstabilize_pointer(node.data_end);
     }
 };
 
+/**
+ * The navigate_index callback structure used by stab_search_batch. The values
+ * are navigated on ascending order. As in the stab-forward helper, we keep
+ * track of the nodes visited_nodes[i] (of height i) at which a previous value
+ * navigated to the left child and of the first event start_asc_it[i] in their
+ * ascending start-time ordered left-list that started after that value. All
+ * events before start_asc_it[i] start at-or-before the current value and need
+ * not be compared again.
+ */
+template <class StabForest, class OutputIterator>
+struct basic_stab_batch_operations
+{
+    using stab_forest_type = StabForest;
+    using timestamp = typename stab_forest_type::timestamp;
+    using event = typename stab_forest_type::event;
+    using stab_tree_node = typename stab_forest_type::stab_tree_node;
+    using const_node_pointer = const stab_tree_node *;
+
+    basic_stab_batch_operations(const stab_forest_type &forest, OutputIterator output) : forest(forest),
+                                                                                         output(output),
+                                                                                         visited_nodes(forest.index.empty() ? 0u : forest.index_height() + 1),
+                                                                                         start_asc_it(visited_nodes.size()) {}
+
+    const stab_forest_type &forest;
+    OutputIterator output;
+    std::vector<const_node_pointer> visited_nodes;
+    std::vector<const event *> start_asc_it;
+
+    void before_trees(const timestamp value)
+    {
+        for (auto it = forest.event_list.cbegin(); it != forest.event_list.cend() && it->start <= value; ++it)
+        {
+            write(value, *it);
+        }
+    }
+
+    void after_trees(const timestamp value)
+    {
+        /* Search stab results in the max-lists of tree roots. */
+        for (auto &fp : forest.index)
+        {
+            right_child(fp, value);
+        }
+
+        /* See if we need to include the event-list tail. */
+        if (!forest.empty() && (value >= forest.event_list.back().start))
+        {
+            auto rbegin = std::make_reverse_iterator(forest.event_list.cend());
+            auto rend = std::make_reverse_iterator(forest.unstabilize_pointer(forest.tail_pointer));
+            write_end_dec(rbegin, rend, value);
+        }
+    }
+
+    void left_child(const stab_tree_node &node, const timestamp value)
+    {
+        auto begin = stab_forest_type::nll_sa_begin(node);
+        auto end = stab_forest_type::nll_sa_end(node);
+        if (visited_nodes[node.height] != &node)
+        {
+            visited_nodes[node.height] = &node;
+            start_asc_it[node.height] = begin;
+        }
+
+        auto it = begin;
+        for (; it != start_asc_it[node.height]; ++it)
+        {
+            write(value, *it);
+        }
+        for (; it != end && it->start <= value; ++it)
+        {
+            write(value, *it);
+        }
+        start_asc_it[node.height] = it;
+    }
+
+    void right_child(const stab_tree_node &node, const timestamp value)
+    {
+        write_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), value);
+        write_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), value);
+    }
+
+    void select_node(const stab_tree_node &node, const timestamp value)
+    {
+        if (value == node.dkey)
+        {
+            write_end_dec(stab_forest_type::dll_ed_begin(node), stab_forest_type::dll_ed_end(node), value);
+        }
+        write_end_dec(stab_forest_type::nll_ed_begin(node), stab_forest_type::nll_ed_end(node), value);
+    }
+
+    /**
+     * Write the events in the descending end-time ordered list [first, last)
+     * that end at-or-after value.
+     */
+    template <class InIt>
+    void write_end_dec(InIt first, InIt last, const timestamp value)
+    {
+        for (; first != last && first->end >= value; ++first)
+        {
+            write(value, *first);
+        }
+    }
+
+    void write(const timestamp value, const event &e)
+    {
+        *output++ = std::pair<timestamp, event>(value, e);
+    }
+};
 
 #endif
\ No newline at end of file
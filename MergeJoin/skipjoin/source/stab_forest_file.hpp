@@ -0,0 +1,575 @@
+#ifndef INCLUDE_STAB_FOREST_FILE_HPP
+#define INCLUDE_STAB_FOREST_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "interval.hpp"
+#include "mapped_file.hpp"
+#include "stab_forest.hpp"
+
+/*
+ * Stab-forest file format. A file holds a fixed-size header followed by three
+ * sections, each starting at a 64-byte aligned offset: the event-list (an array
+ * of events), the node records (first all stab-tree nodes in construction
+ * order, then all forest-points in index order), and the left-list data of all
+ * node records. References between node records and from node records to their
+ * left-list data are self-relative offsets and references to the event-list are
+ * indices; the file is position-independent and can be used in-place via a
+ * (read-only) memory mapping.
+ */
+
+/**
+ * Pointer that stores the offset of its target relative to its own address,
+ * such that structures holding these pointers remain valid at any address. A
+ * zero offset represents the null pointer.
+ */
+template <class Type>
+struct relative_pointer
+{
+    std::int64_t offset;
+
+    const Type *get() const
+    {
+        return (offset == 0) ? nullptr
+                             : reinterpret_cast<const Type *>(reinterpret_cast<const char *>(this) + offset);
+    }
+
+    operator const Type *() const
+    {
+        return get();
+    }
+    const Type *operator->() const
+    {
+        return get();
+    }
+
+    /* Return the array-like data() for left-lists. */
+    const Type *data() const
+    {
+        return get();
+    }
+};
+
+/**
+ * The record representing a stab-tree node (or forest-point) in a stab-forest
+ * file. Holds the same fields as stab_forest::stab_tree_node.
+ */
+template <class TimeStampType>
+struct mapped_stab_tree_node
+{
+    using node_pointer = relative_pointer<mapped_stab_tree_node>;
+    using event = interval<TimeStampType>;
+
+    TimeStampType nkey;
+    TimeStampType dkey;
+    node_pointer left_ptr;
+    node_pointer right_ptr;
+    std::uint64_t height;
+    std::uint64_t data_begin;
+    std::uint64_t data_end;
+    std::uint64_t nll_size;
+    std::uint64_t ll_size;
+    relative_pointer<event> ll_raw_data;
+};
+
+/**
+ * The header of a stab-forest file.
+ */
+struct stab_forest_file_header
+{
+    static constexpr char magic_value[4] = {'S', 'K', 'J', 'F'};
+    static constexpr std::uint16_t current_version = 1;
+    static constexpr std::uint16_t byte_order_mark = 0x0102;
+    static constexpr std::uint64_t section_alignment = 64;
+
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t byte_order;
+    std::uint8_t timestamp_size;
+    std::uint8_t reserved[7];
+    std::uint64_t record_size;
+    std::uint64_t event_count;
+    std::uint64_t event_offset;
+    std::uint64_t node_count;
+    std::uint64_t index_count;
+    std::uint64_t record_offset;
+    std::uint64_t ll_count;
+    std::uint64_t ll_offset;
+    std::uint64_t tail_pointer;
+    std::uint64_t min_key;
+};
+
+/**
+ * Read-only stab-forest stored in a stab-forest file. The file is memory-mapped
+ * and used in-place: opening a file only validates its header, after which
+ * stab_search and stab_forward_search are answered directly on the mapping
+ * (using the same navigation as stab_forest). Throw an invalid_argument if the
+ * file is not a valid stab-forest file for the specified timestamp type. The
+ * same holds for stab-forest images in memory, which allows many stab-forests
+ * to share a single allocation.
+ */
+template <class TimeStampType>
+class mapped_stab_forest : private stab_navigation<TimeStampType>
+{
+public:
+    using stab_forest_type = mapped_stab_forest<TimeStampType>;
+
+    using timestamp = TimeStampType;
+    using event = interval<timestamp>;
+    using const_iterator = const event *;
+    using stable_event_pointer = std::uint64_t;
+    using size_type = std::size_t;
+
+    /* The stab-forward helper. */
+    template <class OutputIterator, class JumpPolicy>
+    using stab_forward_helper = basic_stab_forward_helper<stab_forest_type, OutputIterator, JumpPolicy>;
+
+    /**
+     * Map the stab-forest file at the provided path.
+     */
+    explicit mapped_stab_forest(const std::string &path) : file(std::in_place, path), event_list(), index(), tail_pointer(0),
+                                                            min_key(std::numeric_limits<timestamp>::max())
+    {
+        open(file->data(), file->size(), path);
+    }
+
+    /**
+     * Use the stab-forest image (the contents of a stab-forest file) of size
+     * bytes at data in-place. The image is not copied, hence must remain in
+     * scope, and must be aligned like a stab-forest section (64 bytes).
+     */
+    mapped_stab_forest(const char *data, const size_type size) : file(), event_list(), index(), tail_pointer(0),
+                                                                 min_key(std::numeric_limits<timestamp>::max())
+    {
+        open(data, size, "the image");
+    }
+
+    /**
+     * Write the provided stab-forest to out in the stab-forest file format. The
+     * output stream should be opened in binary mode.
+     */
+    template <template <class> class EventList>
+    static void write(std::ostream &out, const stab_forest<timestamp, EventList> &forest);
+
+    /**
+     * Write the provided stab-forest in the stab-forest file format in-place to
+     * the image_size(forest) bytes at data.
+     */
+    template <template <class> class EventList>
+    static void write(char *data, const stab_forest<timestamp, EventList> &forest);
+
+    /**
+     * Return the size in bytes of the stab-forest image of the provided
+     * stab-forest, i.e., the number of bytes written by write.
+     */
+    template <template <class> class EventList>
+    static std::uint64_t image_size(const stab_forest<timestamp, EventList> &forest);
+
+    /**
+     * Return iterators to the begin and one-past-end of the event-list.
+     */
+    const_iterator begin() const
+    {
+        return event_list.cbegin();
+    }
+    const_iterator cbegin() const
+    {
+        return event_list.cbegin();
+    }
+    const_iterator end() const
+    {
+        return event_list.cend();
+    }
+    const_iterator cend() const
+    {
+        return event_list.cend();
+    }
+
+    /**
+     * Return true if the stab-forest does not hold data.
+     */
+    bool empty() const
+    {
+        return event_list.empty();
+    }
+
+    /**
+     * Return the number of events in the stab-forest.
+     */
+    size_type size() const
+    {
+        return event_list.size();
+    }
+
+    /**
+     * Perform a stab and search, see stab_forest::stab_search.
+     */
+    template <class OutputIterator>
+    const_iterator stab_search(const timestamp value, OutputIterator output) const
+    {
+        stab_operations<OutputIterator> operations{*this, output};
+        navigate_index(value, operations);
+        return operations.next_it;
+    }
+
+    /**
+     * Return a stab-forward helper, see stab_forest::stab_forward_search.
+     */
+    template <class OutputIterator, class JumpPolicy>
+    stab_forward_helper<OutputIterator, JumpPolicy> stab_forward_search(OutputIterator output,
+                                                                        const JumpPolicy &policy) const
+    {
+        return stab_forward_helper<OutputIterator, JumpPolicy>{*this, output, policy};
+    }
+
+    template <class OutputIterator, class JumpPolicy>
+    std::shared_ptr<stab_forward_helper<OutputIterator, JumpPolicy>> stab_forward_search_shared(OutputIterator output,
+        const JumpPolicy &policy) const
+    {
+        return std::shared_ptr<stab_forward_helper<OutputIterator, JumpPolicy>>(new stab_forward_helper<OutputIterator, JumpPolicy>(*this, output, policy));
+    }
+
+    /**
+     * Return the height of the index.
+     */
+    size_type index_height() const
+    {
+        return (index.empty()) ? 0 : index.front().height;
+    }
+
+private:
+    using navigation = stab_navigation<TimeStampType>;
+
+    using navigation::nll_sa_begin;
+    using navigation::nll_sa_end;
+    using navigation::dll_ed_begin;
+    using navigation::dll_ed_end;
+    using navigation::nll_ed_begin;
+    using navigation::nll_ed_end;
+    using navigation::copy_start_asc;
+    using navigation::copy_end_dec;
+    using navigation::navigate_stab_tree_node;
+
+    template <class StabForest, class OutputIterator, class JumpPolicy>
+    friend class basic_stab_forward_helper;
+    template <class StabForest, class OutputIterator>
+    friend struct basic_stab_operations;
+
+    using stab_tree_node = mapped_stab_tree_node<timestamp>;
+
+    template <class OutputIterator>
+    using stab_operations = basic_stab_operations<stab_forest_type, OutputIterator>;
+
+    /**
+     * A read-only array in the mapping, providing the list operations the
+     * stab-forward helper uses on the event-list and on the index.
+     */
+    template <class Type>
+    struct mapped_range
+    {
+        const Type *first = nullptr;
+        const Type *last = nullptr;
+
+        const Type *begin() const { return first; }
+        const Type *cbegin() const { return first; }
+        const Type *end() const { return last; }
+        const Type *cend() const { return last; }
+        const Type &front() const { return *first; }
+        const Type &back() const { return *(last - 1); }
+        bool empty() const { return first == last; }
+        size_type size() const { return last - first; }
+    };
+
+    /**
+     * Query and navigate the stab-forest using the index (see
+     * stab_navigation::navigate_index).
+     */
+    template <class NavigateOperations, class... Other>
+    void navigate_index(const timestamp value,
+                        NavigateOperations &op, Other &...other) const
+    {
+        navigation::template navigate_index<stab_tree_node>(index, min_key, value, op, other...);
+    }
+
+    /**
+     * Return an iterator pointing to the event with the provided index.
+     */
+    const_iterator unstabilize_pointer(const stable_event_pointer p) const
+    {
+        return event_list.cbegin() + p;
+    }
+
+    /**
+     * Stream buffer that writes to a fixed-size memory region.
+     */
+    struct image_buffer : std::streambuf
+    {
+        image_buffer(char *data, const std::uint64_t size)
+        {
+            setp(data, data + size);
+        }
+    };
+
+    /**
+     * Validate the header of the image of size bytes at data (named name in
+     * errors) and set up the event-list and the index.
+     */
+    void open(const char *data, const size_type size, const std::string &name)
+    {
+        stab_forest_file_header header;
+        if (size < sizeof(header) ||
+            std::memcmp(data, stab_forest_file_header::magic_value, sizeof(header.magic)) != 0)
+        {
+            throw std::invalid_argument(name + " is not a stab-forest file");
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (header.version != stab_forest_file_header::current_version ||
+            header.byte_order != stab_forest_file_header::byte_order_mark ||
+            header.timestamp_size != sizeof(timestamp) ||
+            header.record_size != sizeof(stab_tree_node))
+        {
+            throw std::invalid_argument(name + " was written for a different stab-forest layout");
+        }
+        if (!in_image(size, header.event_offset, header.event_count, sizeof(event)) ||
+            !in_image(size, header.record_offset, header.node_count + header.index_count, sizeof(stab_tree_node)) ||
+            !in_image(size, header.ll_offset, header.ll_count, sizeof(event)) ||
+            header.tail_pointer > header.event_count)
+        {
+            throw std::invalid_argument(name + " has invalid section bounds");
+        }
+
+        auto events = reinterpret_cast<const event *>(data + header.event_offset);
+        auto records = reinterpret_cast<const stab_tree_node *>(data + header.record_offset);
+        event_list = mapped_range<event>{events, events + header.event_count};
+        index = mapped_range<stab_tree_node>{records + header.node_count,
+                                             records + header.node_count + header.index_count};
+        tail_pointer = header.tail_pointer;
+        min_key = static_cast<timestamp>(header.min_key);
+    }
+
+    /**
+     * Return true if the section of count values of the specified size at the
+     * specified offset lies within the image of image_size bytes and is
+     * suitably aligned.
+     */
+    static bool in_image(const std::uint64_t image_size, const std::uint64_t offset, const std::uint64_t count,
+                         const std::uint64_t size)
+    {
+        return offset <= image_size && offset % alignof(std::uint64_t) == 0 &&
+               count <= (image_size - offset) / size;
+    }
+
+    /* The mapped file (if the stab-forest is not an image in memory). */
+    std::optional<mapped_file> file;
+
+    /* The event-list and the forest-points in the mapped file. */
+    mapped_range<event> event_list;
+    mapped_range<stab_tree_node> index;
+
+    /* The tail pointer. */
+    stable_event_pointer tail_pointer;
+
+    /* The start-time of the first event in the event list. */
+    timestamp min_key;
+};
+
+template <class TimeStampType>
+template <template <class> class EventList>
+void mapped_stab_forest<TimeStampType>::write(std::ostream &out, const stab_forest<timestamp, EventList> &forest)
+{
+    using source_forest = stab_forest<timestamp, EventList>;
+    using source_node = typename source_forest::stab_tree_node;
+    using source_iterator = typename source_forest::const_iterator;
+
+    auto align = [](const std::uint64_t offset) {
+        auto a = stab_forest_file_header::section_alignment;
+        return (offset + a - 1) / a * a;
+    };
+    auto pad = [&out](const std::uint64_t size) {
+        static const char zeros[stab_forest_file_header::section_alignment] = {};
+        auto a = stab_forest_file_header::section_alignment;
+        out.write(zeros, (a - size % a) % a);
+    };
+
+    /* Translate stable event pointers into indices. */
+    std::unordered_map<const event *, std::uint64_t> event_numbers;
+    if constexpr (!std::is_base_of_v<std::random_access_iterator_tag,
+                                     typename std::iterator_traits<source_iterator>::iterator_category>)
+    {
+        std::uint64_t i = 0;
+        for (auto it = forest.cbegin(); it != forest.cend(); ++it, ++i)
+        {
+            event_numbers.emplace(&*it, i);
+        }
+    }
+    auto event_number = [&](const typename source_forest::stable_event_pointer p) -> std::uint64_t {
+        auto it = forest.unstabilize_pointer(p);
+        if constexpr (std::is_base_of_v<std::random_access_iterator_tag,
+                                        typename std::iterator_traits<source_iterator>::iterator_category>)
+        {
+            return std::distance(forest.cbegin(), it);
+        }
+        else
+        {
+            return (it == forest.cend()) ? forest.size() : event_numbers.at(&*it);
+        }
+    };
+
+    /* Number the records: first the stab-tree nodes, then the forest-points. */
+    std::vector<const source_node *> sources;
+    std::unordered_map<const source_node *, std::uint64_t> record_numbers;
+    for (auto &node : forest.nodes)
+    {
+        record_numbers.emplace(&node, sources.size());
+        sources.push_back(&node);
+    }
+    for (auto &fp : forest.index)
+    {
+        record_numbers.emplace(&fp, sources.size());
+        sources.push_back(&fp);
+    }
+
+    stab_forest_file_header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, stab_forest_file_header::magic_value, sizeof(header.magic));
+    header.version = stab_forest_file_header::current_version;
+    header.byte_order = stab_forest_file_header::byte_order_mark;
+    header.timestamp_size = sizeof(timestamp);
+    header.record_size = sizeof(stab_tree_node);
+    header.event_count = forest.size();
+    header.event_offset = align(sizeof(header));
+    header.node_count = forest.nodes.size();
+    header.index_count = forest.index.size();
+    header.record_offset = align(header.event_offset + header.event_count * sizeof(event));
+    header.ll_offset = align(header.record_offset + sources.size() * sizeof(stab_tree_node));
+    header.tail_pointer = event_number(forest.tail_pointer);
+    header.min_key = forest.min_key;
+    for (auto node : sources)
+    {
+        header.ll_count += node->ll_size + node->nll_size;
+    }
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    pad(sizeof(header));
+
+    /* The event-list. */
+    std::vector<event> buffer;
+    buffer.reserve(4096);
+    for (auto it = forest.cbegin(); it != forest.cend(); ++it)
+    {
+        buffer.push_back(event{it->start, it->end});
+        if (buffer.size() == buffer.capacity())
+        {
+            out.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(event));
+            buffer.clear();
+        }
+    }
+    out.write(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(event));
+    pad(header.event_count * sizeof(event));
+
+    /* The node records. */
+    auto relative = [](const std::uint64_t target, const std::uint64_t field) {
+        return static_cast<std::int64_t>(target) - static_cast<std::int64_t>(field);
+    };
+    std::uint64_t ll_position = header.ll_offset;
+    for (std::uint64_t i = 0; i < sources.size(); ++i)
+    {
+        const source_node &node = *sources[i];
+        std::uint64_t position = header.record_offset + i * sizeof(stab_tree_node);
+
+        stab_tree_node record;
+        std::memset(&record, 0, sizeof(record));
+        record.nkey = node.nkey;
+        record.dkey = node.dkey;
+        if (node.left_ptr != nullptr)
+        {
+            auto target = header.record_offset + record_numbers.at(node.left_ptr) * sizeof(stab_tree_node);
+            record.left_ptr.offset = relative(target, position + offsetof(stab_tree_node, left_ptr));
+        }
+        if (node.right_ptr != nullptr)
+        {
+            auto target = header.record_offset + record_numbers.at(node.right_ptr) * sizeof(stab_tree_node);
+            record.right_ptr.offset = relative(target, position + offsetof(stab_tree_node, right_ptr));
+        }
+        record.height = node.height;
+        record.data_begin = event_number(node.data_begin);
+        record.data_end = event_number(node.data_end);
+        record.nll_size = node.nll_size;
+        record.ll_size = node.ll_size;
+        if (node.ll_size + node.nll_size != 0)
+        {
+            record.ll_raw_data.offset = relative(ll_position, position + offsetof(stab_tree_node, ll_raw_data));
+            ll_position += (node.ll_size + node.nll_size) * sizeof(event);
+        }
+        out.write(reinterpret_cast<const char *>(&record), sizeof(record));
+    }
+    pad(sources.size() * sizeof(stab_tree_node));
+
+    /* The left-lists. */
+    for (auto node : sources)
+    {
+        out.write(reinterpret_cast<const char *>(node->ll_raw_data.data()),
+                  (node->ll_size + node->nll_size) * sizeof(event));
+    }
+    if (!out)
+    {
+        throw std::invalid_argument("could not write stab-forest file");
+    }
+}
+
+template <class TimeStampType>
+template <template <class> class EventList>
+void mapped_stab_forest<TimeStampType>::write(char *data, const stab_forest<timestamp, EventList> &forest)
+{
+    image_buffer buffer(data, image_size(forest));
+    std::ostream out(&buffer);
+    write(out, forest);
+}
+
+template <class TimeStampType>
+template <template <class> class EventList>
+std::uint64_t mapped_stab_forest<TimeStampType>::image_size(const stab_forest<timestamp, EventList> &forest)
+{
+    auto align = [](const std::uint64_t offset) {
+        auto a = stab_forest_file_header::section_alignment;
+        return (offset + a - 1) / a * a;
+    };
+
+    std::uint64_t ll_count = 0;
+    for (auto &node : forest.nodes)
+    {
+        ll_count += node.ll_size + node.nll_size;
+    }
+    for (auto &fp : forest.index)
+    {
+        ll_count += fp.ll_size + fp.nll_size;
+    }
+
+    auto record_offset = align(align(sizeof(stab_forest_file_header)) + forest.size() * sizeof(event));
+    auto ll_offset = align(record_offset + (forest.nodes.size() + forest.index.size()) * sizeof(stab_tree_node));
+    return ll_offset + ll_count * sizeof(event);
+}
+
+/**
+ * Write the provided stab-forest to out in the stab-forest file format (see
+ * mapped_stab_forest).
+ */
+template <class TimeStampType, template <class> class EventList>
+void write_stab_forest(std::ostream &out, const stab_forest<TimeStampType, EventList> &forest)
+{
+    mapped_stab_forest<TimeStampType>::write(out, forest);
+}
+
+#endif
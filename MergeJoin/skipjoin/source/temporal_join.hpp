@@ -27,10 +27,17 @@
 #ifndef INCLUDE_TEMPORAL_JOIN_HPP
 #define INCLUDE_TEMPORAL_JOIN_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <functional>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
+#include "simd_scan.hpp"
 
 namespace temporal_join_details
 {
@@ -60,11 +67,32 @@ namespace temporal_join_details
         }
     };
 
+    /**
+     * Output iterators that can consume the complete range of events joining
+     * with a single event at once (see join_sink.hpp).
+     */
+    template <class OutputIterator, class Join, class Event, class ConstIterator>
+    concept range_join_output = requires(OutputIterator output, const Event &event, ConstIterator it) {
+        output.template join_range<Join>(event, it, it);
+    };
+
+    /**
+     * Return value + delta, or the largest timestamp if that overflows.
+     */
+    template <class TimeStampType>
+    TimeStampType saturating_add(const TimeStampType value, const TimeStampType delta)
+    {
+        return value > std::numeric_limits<TimeStampType>::max() - delta ? std::numeric_limits<TimeStampType>::max()
+                                                                           : static_cast<TimeStampType>(value + delta);
+    }
+
     /**
      * Helper structure that will join single events with the currently set
      * range in a forward scan fashion. Single events are sent to this structure
      * via push_back operators, allowing this structure to be used in
-     * conjunction with std::back_inserter.
+     * conjunction with std::back_inserter. Events are joined with the events
+     * of the range that start at-or-before their end extended by delta (zero
+     * for the overlap join, see forward_band_skip_join).
      */
     template <class Join, class ConstIterator, class OutputIterator>
     struct stab_result_join
@@ -72,23 +100,58 @@ namespace temporal_join_details
         using const_iterator = ConstIterator;
         using output_iterator = OutputIterator;
         using value_type = typename std::iterator_traits<const_iterator>::value_type;
+        using timestamp = typename value_type::unsigned_type;
 
         /**
-         * Construct the helper structure by specifying the end of the range
-         * and an output iterator to write join results to.
+         * Construct the helper structure by specifying the end of the range,
+         * an output iterator to write join results to, and the band width.
          */
-        stab_result_join(const_iterator end, output_iterator output) : iterator(end), end(end), output(output) {}
+        stab_result_join(const_iterator end, output_iterator output, const timestamp delta = 0) : iterator(end), end(end),
+                                                                                                  output(output),
+                                                                                                  delta(delta) {}
 
         /**
          * Join the provided event with the currently set range.
          */
         void push_back(const value_type &event)
         {
-            auto it = iterator;
-            while (it != end && it->start <= event.end)
+            const auto last_start = saturating_add(event.end, delta);
+
+            /* The range is sorted on start-time: sinks that aggregate the range
+             * as a whole get its end by binary search. */
+            if constexpr (range_join_output<output_iterator, Join, value_type, const_iterator>)
+            {
+                auto last = std::upper_bound(iterator, end, last_start, value_type::start_compare());
+                output.template join_range<Join>(event, iterator, last);
+            }
+            /* Contiguous event-lists (vector_event_list): find the end of the
+             * range with the (vectorized) scan, then emit without comparisons. */
+            else if constexpr (std::contiguous_iterator<const_iterator>)
+            {
+                auto first = std::to_address(iterator);
+                auto last = find_start_after(first, std::to_address(end), last_start);
+                for (; first != last; ++first)
+                {
+                    Join::join(event, *first, output);
+                }
+            }
+            /* Column event-lists (soa_event_list): scan the start-times only. */
+            else if constexpr (requires(const_iterator it) { it.start_data(); })
             {
-                Join::join(event, *it, output);
-                ++it;
+                auto last = iterator + (find_value_after(iterator.start_data(), end.start_data(), last_start) - iterator.start_data());
+                for (auto it = iterator; it != last; ++it)
+                {
+                    Join::join(event, *it, output);
+                }
+            }
+            else
+            {
+                auto it = iterator;
+                while (it != end && it->start <= last_start)
+                {
+                    Join::join(event, *it, output);
+                    ++it;
+                }
             }
         }
 
@@ -107,16 +170,335 @@ namespace temporal_join_details
 
         /* Output iterator for the join output. */
         output_iterator output;
+
+        /* Band width by which the end of the joined events is extended. */
+        timestamp delta;
     };
 
     /**
      * Return a stab_result_join helper structure with the specified end of the
-     * range and the specified output iterator to write join results to.
+     * range, the specified output iterator to write join results to, and the
+     * specified band width.
      */
     template <class Join, class ConstIterator, class OutputIterator>
-    stab_result_join<Join, ConstIterator, OutputIterator> make_stab_result_join(ConstIterator end, OutputIterator output)
+    stab_result_join<Join, ConstIterator, OutputIterator> make_stab_result_join(ConstIterator end, OutputIterator output,
+                                                                                const typename std::iterator_traits<ConstIterator>::value_type::unsigned_type delta = 0)
     {
-        return stab_result_join<Join, ConstIterator, OutputIterator>(end, output);
+        return stab_result_join<Join, ConstIterator, OutputIterator>(end, output, delta);
+    }
+
+    /**
+     * Return an iterator to the first event in [first, last) that starts
+     * after value. The events in [first, last) must be sorted on start-time.
+     */
+    template <class ConstIterator, class TimeStampType>
+    ConstIterator start_upper_bound(ConstIterator first, const ConstIterator last, const TimeStampType value)
+    {
+        if constexpr (std::contiguous_iterator<ConstIterator>)
+        {
+            auto begin = std::to_address(first);
+            return first + (find_start_after(begin, std::to_address(last), value) - begin);
+        }
+        else if constexpr (requires(ConstIterator it) { it.start_data(); })
+        {
+            return first + (find_value_after(first.start_data(), last.start_data(), value) - first.start_data());
+        }
+        else
+        {
+            while (first != last && first->start <= value)
+            {
+                ++first;
+            }
+            return first;
+        }
+    }
+
+    /**
+     * The start-times of the candidates of an event in a predicate join (see
+     * allen_skip_join): the candidates of event x are the events y of the
+     * other side with x.start <= y.start <= x.end (those found by the
+     * overlap join), of which only those with y.start = x.start (tie) or
+     * with y.start = x.end (end) can satisfy some relations.
+     */
+    enum class candidate_range
+    {
+        none,
+        tie,
+        overlap,
+        end
+    };
+
+    /**
+     * Helper structure that joins single events with the candidates in the
+     * currently set range, like stab_result_join, but only visits the
+     * candidates in the candidate_range of Side and only writes the pairs that
+     * satisfy Side::match(event, candidate).
+     */
+    template <class Join, class Side, class ConstIterator, class OutputIterator>
+    struct relation_result_join
+    {
+        using const_iterator = ConstIterator;
+        using output_iterator = OutputIterator;
+        using value_type = typename std::iterator_traits<const_iterator>::value_type;
+
+        /**
+         * Construct the helper structure by specifying the end of the range
+         * and an output iterator to write join results to.
+         */
+        relation_result_join(const_iterator end, output_iterator output) : iterator(end), end(end), output(output) {}
+
+        /**
+         * Join the provided event with the candidates in the currently set
+         * range.
+         */
+        void push_back(const value_type &event)
+        {
+            if constexpr (Side::range != candidate_range::none)
+            {
+                auto first = iterator;
+                if constexpr (Side::range == candidate_range::end)
+                {
+                    if (event.start != event.end)
+                    {
+                        first = start_upper_bound(iterator, end, event.end - 1);
+                    }
+                }
+                auto last = start_upper_bound(first, end, Side::range == candidate_range::tie ? event.start : event.end);
+                for (; first != last; ++first)
+                {
+                    if (Side::match(event, *first))
+                    {
+                        Join::join(event, *first, output);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Set the start of the range.
+         */
+        void set_iterator(const const_iterator it)
+        {
+            iterator = it;
+        }
+
+    private:
+        /* Current range [iterator, end[. */
+        const_iterator iterator;
+        const_iterator end;
+
+        /* Output iterator for the join output. */
+        output_iterator output;
+    };
+
+    /**
+     * Return a relation_result_join helper structure with the specified end
+     * of the range and the specified output iterator to write join results to.
+     */
+    template <class Join, class Side, class ConstIterator, class OutputIterator>
+    relation_result_join<Join, Side, ConstIterator, OutputIterator> make_relation_result_join(ConstIterator end, OutputIterator output)
+    {
+        return relation_result_join<Join, Side, ConstIterator, OutputIterator>(end, output);
+    }
+
+    /**
+     * Output iterator that keeps the largest end-time of the events written to
+     * it. Copies of the iterator update the same end-time.
+     */
+    template <class TimeStampType>
+    struct max_end_output
+    {
+        using iterator_category = std::output_iterator_tag;
+        using value_type = void;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = void;
+
+        explicit max_end_output(std::optional<TimeStampType> &max_end) : max_end(&max_end) {}
+
+        max_end_output &operator*() { return *this; }
+        max_end_output &operator++() { return *this; }
+        max_end_output &operator++(int) { return *this; }
+
+        template <class Event>
+        max_end_output &operator=(const Event &event)
+        {
+            if (!*max_end || **max_end < event.end)
+            {
+                *max_end = event.end;
+            }
+            return *this;
+        }
+
+    private:
+        std::optional<TimeStampType> *max_end;
+    };
+
+    /**
+     * Sweep-based semi-join (Anti = false) or anti-join (Anti = true) with
+     * skipping: write the events of lhs that do (not) overlap any event of rhs
+     * to output.
+     *
+     * The sweep only keeps the largest end-time (the reach) of the events of
+     * rhs that start at-or-before the current event of lhs: that event
+     * overlaps an event of rhs if the reach is at-or-after its start, or if
+     * the next event of rhs starts at-or-before its end. Hence, every event of
+     * lhs is decided by two comparisons, without visiting its partners. The
+     * events of rhs are passed by stab-forward jumps that only update the
+     * reach. In the semi-join, the events of lhs that are not decided yet are
+     * passed by stab-forward jumps to the start of the next event of rhs: the
+     * events found by these jumps are active at that start, hence are written
+     * directly, while all other passed events have no partner.
+     */
+    template <bool Anti, class Forest, class OutputIterator, class JumpPolicyL, class JumpPolicyR>
+    void filter_skip_join(const Forest &lhs, const Forest &rhs, OutputIterator output,
+                          const JumpPolicyL &policy_l, const JumpPolicyR &policy_r)
+    {
+        using timestamp = typename Forest::timestamp;
+
+        std::optional<timestamp> reach;
+        auto lit = lhs.stab_forward_search(output, policy_l);
+        auto lend = lhs.cend();
+        auto rit = rhs.stab_forward_search(max_end_output<timestamp>(reach), policy_r);
+        auto rend = rhs.cend();
+        while (lit != lend && rit != rend)
+        {
+            if (rit->start <= lit->start)
+            {
+                rit.stab_forward(lit->start);
+            }
+            else if ((reach && lit->start <= *reach) || rit->start <= lit->end)
+            {
+                if constexpr (!Anti)
+                {
+                    *output++ = *lit;
+                }
+                ++lit;
+            }
+            else if constexpr (Anti)
+            {
+                *output++ = *lit;
+                ++lit;
+            }
+            else
+            {
+                lit.stab_forward(rit->start);
+            }
+        }
+
+        /* The remaining events of lhs only overlap the events of rhs by the
+         * reach, which precedes the start of all events after the first that
+         * does not overlap. */
+        for (; lit != lend && reach && lit->start <= *reach; ++lit)
+        {
+            if constexpr (!Anti)
+            {
+                *output++ = *lit;
+            }
+        }
+        if constexpr (Anti)
+        {
+            for (; lit != lend; ++lit)
+            {
+                *output++ = *lit;
+            }
+        }
+    }
+
+    /**
+     * The events of one input of a multi-way join that may still be active,
+     * with the largest end-time among them: none of the events is active at
+     * a timestamp after that end-time. Events are added via push_back, such
+     * that they can be written by a stab-forward helper via std::back_inserter.
+     */
+    template <class Event>
+    struct active_events
+    {
+        using value_type = Event;
+        using timestamp = typename value_type::unsigned_type;
+
+        void push_back(const value_type &event)
+        {
+            events.push_back(event);
+            if (!max_end || *max_end < event.end)
+            {
+                max_end = event.end;
+            }
+        }
+
+        /**
+         * Return true if an event is active at value, which must not precede
+         * previous values provided to active_at and prune.
+         */
+        bool active_at(const timestamp value) const
+        {
+            return max_end && value <= *max_end;
+        }
+
+        /**
+         * Remove the events that end before value.
+         */
+        void prune(const timestamp value)
+        {
+            std::erase_if(events, [value](const value_type &event) { return event.end < value; });
+        }
+
+        std::vector<value_type> events;
+        std::optional<timestamp> max_end;
+    };
+
+    /**
+     * Sweep-based forward-scan join with skipping of the events in [lit, lend)
+     * of lhs with the events in [rit, rend) of rhs: only pairs of events from
+     * both ranges are written to output.
+     */
+    template <class Forest, class ConstIterator, class OutputIterator, class JumpPolicyL, class JumpPolicyR>
+    void forward_skip_join_ranges(const Forest &lhs, const Forest &rhs,
+                                  ConstIterator lit, const ConstIterator lend,
+                                  ConstIterator rit, const ConstIterator rend, OutputIterator output,
+                                  const JumpPolicyL &policy_l, const JumpPolicyR &policy_r)
+    {
+        if (lit == lend || rit == rend)
+        {
+            return;
+        }
+
+        /* Helpers to join events. */
+        auto stab_left_rj = make_stab_result_join<join_1>(rend, output);
+        auto stab_right_rj = make_stab_result_join<join_2>(lend, output);
+
+        /* The helpers only jump; the positions are kept in lit and rit. */
+        auto lhelper = lhs.stab_forward_search(std::back_inserter(stab_left_rj), policy_l);
+        auto rhelper = rhs.stab_forward_search(std::back_inserter(stab_right_rj), policy_r);
+        while (lit != lend && rit != rend)
+        {
+            if (lit->start <= rit->start)
+            {
+                stab_left_rj.set_iterator(rit);
+                if (rit->start <= lit->end)
+                {
+                    stab_left_rj.push_back(*lit);
+                    ++lit;
+                }
+                else
+                {
+                    lhelper.stab_forward(rit->start, &lit);
+                }
+            }
+            else
+            {
+                stab_right_rj.set_iterator(lit);
+                if (lit->start <= rit->end)
+                {
+                    stab_right_rj.push_back(*rit);
+                    ++rit;
+                }
+                else
+                {
+                    rhelper.stab_forward(lit->start, &rit);
+                }
+            }
+        }
     }
 }
 
@@ -201,4 +583,517 @@ void forward_skip_join(const Forest &lhs, const Forest &rhs, OutputIterator outp
     }
 }
 
+/**
+ * Sweep-based band join with skipping: join the pairs of events that overlap
+ * when one of them is extended by delta on both sides, i.e., the pairs of
+ * events that are at most delta apart. The stab-forests are used as they are:
+ * the band width is applied in the comparisons and in the stab-forward jumps,
+ * which jump to delta before the start of the next event of the other side.
+ */
+template <class Forest, class OutputIterator, class JumpPolicyL, class JumpPolicyR>
+void forward_band_skip_join(const Forest &lhs, const Forest &rhs, const typename Forest::timestamp delta,
+                            OutputIterator output, const JumpPolicyL &policy_l, const JumpPolicyR &policy_r)
+{
+    using namespace temporal_join_details;
+
+    /* Helpers to join events. */
+    auto stab_left_rj = make_stab_result_join<join_1>(rhs.cend(), output, delta);
+    auto stab_right_rj = make_stab_result_join<join_2>(lhs.cend(), output, delta);
+
+    /* Join while we have not reached the end of both lists. Jumps only happen
+     * if the next event of the other side starts more than delta after the
+     * end of the current event, hence the jump targets do not underflow. */
+    auto lit = lhs.stab_forward_search(std::back_inserter(stab_left_rj), policy_l);
+    auto lend = lhs.cend();
+    auto rit = rhs.stab_forward_search(std::back_inserter(stab_right_rj), policy_r);
+    auto rend = rhs.cend();
+    while (lit != lend && rit != rend)
+    {
+        if (lit->start <= rit->start)
+        {
+            stab_left_rj.set_iterator(rit.get_iterator());
+            if (rit->start <= saturating_add(lit->end, delta))
+            {
+                stab_left_rj.push_back(*lit);
+                ++lit;
+            }
+            else
+            {
+                lit.stab_forward(rit->start - delta);
+            }
+        }
+        else
+        {
+            stab_right_rj.set_iterator(lit.get_iterator());
+            if (lit->start <= saturating_add(rit->end, delta))
+            {
+                stab_right_rj.push_back(*rit);
+                ++rit;
+            }
+            else
+            {
+                rit.stab_forward(lit->start - delta);
+            }
+        }
+    }
+}
+
+/**
+ * Sweep-based semi-join with skipping: write every event of lhs that overlaps
+ * at least one event of rhs to output, once. The events are not necessarily
+ * written in start-time order.
+ */
+template <class Forest, class OutputIterator, class JumpPolicyL, class JumpPolicyR>
+void semi_skip_join(const Forest &lhs, const Forest &rhs, OutputIterator output,
+                    const JumpPolicyL &policy_l, const JumpPolicyR &policy_r)
+{
+    temporal_join_details::filter_skip_join<false>(lhs, rhs, output, policy_l, policy_r);
+}
+
+/**
+ * Sweep-based anti-join with skipping: write every event of lhs that overlaps
+ * no event of rhs to output, in start-time order.
+ */
+template <class Forest, class OutputIterator, class JumpPolicyL, class JumpPolicyR>
+void anti_skip_join(const Forest &lhs, const Forest &rhs, OutputIterator output,
+                    const JumpPolicyL &policy_l, const JumpPolicyR &policy_r)
+{
+    temporal_join_details::filter_skip_join<true>(lhs, rhs, output, policy_l, policy_r);
+}
+
+/*
+ * Allen relations between the (closed) intervals l of the left-hand side and r
+ * of the right-hand side of a predicate join (see allen_skip_join). Only the
+ * relations that imply that l and r overlap are supported: the pairs in
+ * before/after relations are not found by the forward-scan join.
+ *
+ * Every relation describes how to find its pairs in both sweep directions: the
+ * left side is used when an event x of the left-hand side is joined with the
+ * events y of the right-hand side that start at-or-after x, the right side
+ * when an event x of the right-hand side is joined with the events y of the
+ * left-hand side that start at-or-after x. Each side specifies which of these
+ * events are candidates (candidate_range) and which candidates are written
+ * (match(x, y)).
+ */
+
+/**
+ * Pairs of intervals that overlap, which is the join of forward_skip_join.
+ */
+struct allen_intersects
+{
+    struct left
+    {
+        static constexpr auto range = temporal_join_details::candidate_range::overlap;
+
+        template <class Event>
+        static bool match(const Event &, const Event &) { return true; }
+    };
+    using right = left;
+};
+
+/**
+ * Pairs in which l contains r: l.start <= r.start and r.end <= l.end.
+ */
+struct allen_contains
+{
+    struct left
+    {
+        static constexpr auto range = temporal_join_details::candidate_range::overlap;
+
+        template <class Event>
+        static bool match(const Event &x, const Event &y) { return y.end <= x.end; }
+    };
+    struct right
+    {
+        static constexpr auto range = temporal_join_details::candidate_range::tie;
+
+        template <class Event>
+        static bool match(const Event &x, const Event &y) { return x.end <= y.end; }
+    };
+};
+
+/**
+ * Pairs in which l is contained in r: r.start <= l.start and l.end <= r.end.
+ */
+struct allen_during
+{
+    using left = allen_contains::right;
+    using right = allen_contains::left;
+};
+
+/**
+ * Pairs in which l overlaps the start of r: l.start < r.start <= l.end < r.end.
+ */
+struct allen_overlaps
+{
+    struct left
+    {
+        static constexpr auto range = temporal_join_details::candidate_range::overlap;
+
+        template <class Event>
+        static bool match(const Event &x, const Event &y) { return x.start < y.start && x.end < y.end; }
+    };
+    struct right
+    {
+        static constexpr auto range = temporal_join_details::candidate_range::none;
+    };
+};
+
+/**
+ * Pairs in which r overlaps the start of l: r.start < l.start <= r.end < l.end.
+ */
+struct allen_overlapped_by
+{
+    using left = allen_overlaps::right;
+    using right = allen_overlaps::left;
+};
+
+/**
+ * Pairs in which l ends where r starts: l.end = r.start.
+ */
+struct allen_meets
+{
+    struct left
+    {
+        static constexpr auto range = temporal_join_details::candidate_range::end;
+
+        template <class Event>
+        static bool match(const Event &, const Event &) { return true; }
+    };
+    struct right
+    {
+        static constexpr auto range = temporal_join_details::candidate_range::tie;
+
+        template <class Event>
+        static bool match(const Event &x, const Event &y) { return y.end == x.start; }
+    };
+};
+
+/**
+ * Pairs in which r ends where l starts: r.end = l.start.
+ */
+struct allen_met_by
+{
+    using left = allen_meets::right;
+    using right = allen_meets::left;
+};
+
+/**
+ * Pairs in which l starts within r: r.start <= l.start <= r.end.
+ */
+struct allen_starts_within
+{
+    struct left
+    {
+        static constexpr auto range = temporal_join_details::candidate_range::tie;
+
+        template <class Event>
+        static bool match(const Event &, const Event &) { return true; }
+    };
+    using right = allen_intersects::right;
+};
+
+/**
+ * Sweep-based forward-scan join with skipping that only writes the pairs in
+ * the provided Allen relation. The sweep and its jumps are those of
+ * forward_skip_join; only the candidates of each event in the relation are
+ * visited, hence sweep directions in which the relation cannot hold visit no
+ * candidates at all, and directions in which only ties (or events starting at
+ * the end of the event) can be in the relation visit only those.
+ */
+template <class Relation, class Forest, class OutputIterator, class JumpPolicyL, class JumpPolicyR>
+void allen_skip_join(const Forest &lhs, const Forest &rhs, OutputIterator output,
+                     const JumpPolicyL &policy_l, const JumpPolicyR &policy_r)
+{
+    using namespace temporal_join_details;
+    using left = typename Relation::left;
+    using right = typename Relation::right;
+
+    /* Helpers to join events. */
+    auto stab_left_rj = make_relation_result_join<join_1, left>(rhs.cend(), output);
+    auto stab_right_rj = make_relation_result_join<join_2, right>(lhs.cend(), output);
+
+    /* Join while we have not reached the end of both lists. */
+    auto lit = lhs.stab_forward_search(std::back_inserter(stab_left_rj), policy_l);
+    auto lend = lhs.cend();
+    auto rit = rhs.stab_forward_search(std::back_inserter(stab_right_rj), policy_r);
+    auto rend = rhs.cend();
+    while (lit != lend && rit != rend)
+    {
+        if (lit->start <= rit->start)
+        {
+            stab_left_rj.set_iterator(rit.get_iterator());
+            if (rit->start <= lit->end)
+            {
+                stab_left_rj.push_back(*lit);
+                ++lit;
+            }
+            else
+            {
+                lit.stab_forward(rit->start);
+            }
+        }
+        else
+        {
+            stab_right_rj.set_iterator(lit.get_iterator());
+            if (lit->start <= rit->end)
+            {
+                stab_right_rj.push_back(*rit);
+                ++rit;
+            }
+            else
+            {
+                rit.stab_forward(lit->start);
+            }
+        }
+    }
+}
+
+/**
+ * Sweep-based multi-way join with skipping of the K stab-forests in forests:
+ * write every K-tuple holding one event of each stab-forest (in the order of
+ * forests) in which all events overlap, as an std::array of K events. No
+ * intermediate results are produced.
+ *
+ * The sweep visits the events of all stab-forests in start-time order (ties in
+ * the order of forests) and keeps the events that may still be active. Each
+ * tuple is written when its last event is visited: as intervals that overlap
+ * pairwise have a common timestamp, the tuple consists of that event and
+ * events of the other stab-forests that are active at its start. If no event
+ * of some stab-forest is active, no tuple holds a timestamp before the start
+ * of the next event of that stab-forest; all cursors jump there by stab-forward
+ * jumps (only the events found by the jumps become active).
+ */
+template <std::size_t K, class Forest, class OutputIterator, class JumpPolicy>
+void multi_skip_join(const std::array<const Forest *, K> &forests, OutputIterator output, const JumpPolicy &policy)
+{
+    using namespace temporal_join_details;
+    using event = typename Forest::event;
+    using timestamp = typename Forest::timestamp;
+
+    std::array<active_events<event>, K> active;
+    using helper_type = decltype(forests[0]->stab_forward_search(std::back_inserter(active[0]), policy));
+    std::vector<helper_type> cursors;
+    cursors.reserve(K);
+    for (std::size_t i = 0; i < K; ++i)
+    {
+        cursors.push_back(forests[i]->stab_forward_search(std::back_inserter(active[i]), policy));
+    }
+
+    std::array<event, K> tuple;
+    std::array<std::size_t, K> positions;
+    while (true)
+    {
+        /* The first event that is not visited yet. */
+        std::size_t next = K;
+        for (std::size_t i = 0; i < K; ++i)
+        {
+            if (cursors[i] != forests[i]->cend() && (next == K || cursors[i]->start < cursors[next]->start))
+            {
+                next = i;
+            }
+        }
+        if (next == K)
+        {
+            return;
+        }
+
+        /* Jump to the first timestamp at which every stab-forest can have an
+         * active event. */
+        timestamp value = cursors[next]->start;
+        timestamp target = value;
+        for (std::size_t i = 0; i < K; ++i)
+        {
+            if (!active[i].active_at(value))
+            {
+                if (cursors[i] == forests[i]->cend())
+                {
+                    return;
+                }
+                target = std::max(target, cursors[i]->start);
+            }
+        }
+        if (value < target)
+        {
+            for (std::size_t i = 0; i < K; ++i)
+            {
+                if (cursors[i] != forests[i]->cend() && cursors[i]->start < target)
+                {
+                    cursors[i].stab_forward(target);
+                }
+            }
+            continue;
+        }
+
+        /* Write the tuples in which the next event is the last event. */
+        tuple[next] = *cursors[next];
+        ++cursors[next];
+        bool empty = false;
+        for (std::size_t i = 0; i < K; ++i)
+        {
+            if (i != next)
+            {
+                empty = empty || !active[i].active_at(value);
+                positions[i] = 0;
+            }
+        }
+        if (!empty)
+        {
+            for (std::size_t i = 0; i < K; ++i)
+            {
+                if (i != next)
+                {
+                    active[i].prune(value);
+                }
+            }
+        }
+        while (!empty)
+        {
+            for (std::size_t i = 0; i < K; ++i)
+            {
+                if (i != next)
+                {
+                    tuple[i] = active[i].events[positions[i]];
+                }
+            }
+            *output++ = tuple;
+
+            /* Advance to the next combination of active events. */
+            std::size_t i = 0;
+            for (; i < K; ++i)
+            {
+                if (i != next && ++positions[i] < active[i].events.size())
+                {
+                    break;
+                }
+                positions[i] = 0;
+            }
+            empty = i == K;
+        }
+        active[next].push_back(tuple[next]);
+    }
+}
+
+/**
+ * Incremental sweep-based forward-scan join with skipping of two append-only
+ * stab-forests (e.g., two live event streams). Each call advance(watermark,
+ * output) writes exactly the join results that were not written before and in
+ * which both events start at-or-before the watermark. Hence, repeated calls
+ * with increasing watermarks produce the complete join once, without re-running
+ * the join from the beginning. The caller guarantees that, when advancing to a
+ * watermark, all events that start at-or-before the watermark have been
+ * appended to both stab-forests.
+ *
+ * The events that start after the previous watermark and at-or-before the new
+ * watermark are joined by the forward-scan join with skipping, after which the
+ * events that start at-or-before the previous watermark and are still active
+ * at it (the spill-over events, found by a stab) are joined with the new events
+ * of the other side. Between calls, the previous watermark and the positions of
+ * the first events that start after it are kept, the latter as stable pointers
+ * (iterators and the stab-forward helper states of the sweep are not valid once
+ * events have been appended). Hence, a call only visits the new events (of
+ * which the end is found by binary search on random-access event-lists) and
+ * the spill-over events, and does not depend on the number of events joined
+ * by previous calls.
+ */
+template <class Forest, class JumpPolicyL, class JumpPolicyR>
+class incremental_skip_join
+{
+public:
+    using timestamp = typename Forest::timestamp;
+
+    /**
+     * Construct the incremental join of lhs and rhs, which must remain in
+     * scope, using the provided jump policies.
+     */
+    incremental_skip_join(const Forest &lhs, const Forest &rhs,
+                          const JumpPolicyL &policy_l, const JumpPolicyR &policy_r) : lhs(lhs), rhs(rhs),
+                                                                                      policy_l(policy_l),
+                                                                                      policy_r(policy_r),
+                                                                                      last_watermark(), lhs_position(),
+                                                                                      rhs_position() {}
+
+    /**
+     * Write the join results in which both events start at-or-before the
+     * watermark that have not been written by previous calls. Watermarks
+     * at-or-before the previous watermark are ignored.
+     */
+    template <class OutputIterator>
+    void advance(const timestamp watermark, OutputIterator output)
+    {
+        using namespace temporal_join_details;
+
+        if (last_watermark && watermark <= *last_watermark)
+        {
+            return;
+        }
+
+        /* The new events start in ]last_watermark, watermark]. */
+        auto lit = last_watermark ? lhs.unstabilize_pointer(*lhs_position) : lhs.cbegin();
+        auto rit = last_watermark ? rhs.unstabilize_pointer(*rhs_position) : rhs.cbegin();
+        auto lend = new_events_end(lit, lhs.cend(), watermark);
+        auto rend = new_events_end(rit, rhs.cend(), watermark);
+
+        if (last_watermark)
+        {
+            /* Join the spill-over events with the new events. */
+            auto stab_left_rj = make_stab_result_join<join_1>(rend, output);
+            auto stab_right_rj = make_stab_result_join<join_2>(lend, output);
+            stab_left_rj.set_iterator(rit);
+            lhs.stab_search(*last_watermark, std::back_inserter(stab_left_rj));
+            stab_right_rj.set_iterator(lit);
+            rhs.stab_search(*last_watermark, std::back_inserter(stab_right_rj));
+        }
+
+        forward_skip_join_ranges(lhs, rhs, lit, lend, rit, rend, output, policy_l, policy_r);
+        last_watermark = watermark;
+        lhs_position = lhs.stabilize_iterator(lend);
+        rhs_position = rhs.stabilize_iterator(rend);
+    }
+
+    /**
+     * Return the watermark of the last call to advance (if any).
+     */
+    std::optional<timestamp> watermark() const
+    {
+        return last_watermark;
+    }
+
+private:
+    using stable_event_pointer = typename Forest::stable_event_pointer;
+
+    /**
+     * Return an iterator to the first event in [first, last) that starts after
+     * watermark.
+     */
+    template <class ConstIterator>
+    static ConstIterator new_events_end(const ConstIterator first, const ConstIterator last, const timestamp watermark)
+    {
+        using value_type = typename std::iterator_traits<ConstIterator>::value_type;
+        if constexpr (std::random_access_iterator<ConstIterator>)
+        {
+            return std::upper_bound(first, last, watermark, value_type::start_compare());
+        }
+        else
+        {
+            return temporal_join_details::start_upper_bound(first, last, watermark);
+        }
+    }
+
+    /* The joined stab-forests. */
+    const Forest &lhs;
+    const Forest &rhs;
+
+    /* The jump policies of the stab-forward helpers. */
+    JumpPolicyL policy_l;
+    JumpPolicyR policy_r;
+
+    /* The watermark of the last call to advance (if any). */
+    std::optional<timestamp> last_watermark;
+
+    /* The first events of lhs and rhs that start after the last watermark. */
+    std::optional<stable_event_pointer> lhs_position;
+    std::optional<stable_event_pointer> rhs_position;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "binary_dataset.hpp"
+#include "dataset.hpp"
+
+/**
+ * Convert between the text format (whitespace-separated (start, end)-pairs) and
+ * the binary interval file format. A text input file is written as a binary
+ * file with raw (default) or delta-encoded columns; a binary input file is
+ * written as a text file.
+ *
+ *   tool_convert <input> <output> [raw|delta]
+ */
+int main(int argc, char* argv[])
+{
+    if (argc != 3 && argc != 4) {
+        return -1;
+    }
+    else {
+        using timestamp = std::uint32_t;
+
+        try {
+            auto encoding = column_encoding::raw;
+            if (argc == 4) {
+                std::string name(argv[3]);
+                if (name == "delta") {
+                    encoding = column_encoding::delta;
+                }
+                else if (name != "raw") {
+                    throw std::invalid_argument("unknown column encoding " + name);
+                }
+            }
+
+            std::ifstream input(argv[1], std::ios::binary);
+            if (!input) {
+                throw std::invalid_argument("could not read input data file");
+            }
+            char magic[sizeof(binary_dataset_header::magic_value)] = {};
+            input.read(magic, sizeof(magic));
+            bool binary_input = is_binary_dataset(magic, static_cast<std::size_t>(input.gcount()));
+
+            if (binary_input) {
+                input.close();
+                binary_dataset<timestamp> dataset(argv[1]);
+                std::ofstream output(argv[2]);
+                if (!output) {
+                    throw std::invalid_argument("could not write output file");
+                }
+                for (auto event : dataset.read_events()) {
+                    output << event.start << ' ' << event.end << '\n';
+                }
+            }
+            else {
+                input.clear();
+                input.seekg(0);
+                auto events = read_events<timestamp>(input);
+                std::ofstream output(argv[2], std::ios::binary);
+                if (!output) {
+                    throw std::invalid_argument("could not write output file");
+                }
+                write_binary_events(output, events.cbegin(), events.cend(), encoding);
+            }
+        }
+        catch (std::exception& ex) {
+            std::cout << "error: " << ex.what() << std::endl;
+            return 2;
+        }
+    }
+}